@@ -1,47 +1,79 @@
+#include <cstring>
+#include <cctype>
+#include <climits>
+
 #include "bed.h"
+#include "variant.h"
 #include "print.h"
+#include "file.h"
+
+/* Parse a BED coordinate from field [beg, end), accepting the same input as 
+ * std::stoi (leading whitespace and sign, ignoring trailing characters).
+ */
+int parse_bed_int(const char * beg, const char * end) {
+    while (beg < end && isspace(*beg)) beg++;
+    bool neg = beg < end && *beg == '-';
+    if (beg < end && (*beg == '-' || *beg == '+')) beg++;
+    if (beg == end || !isdigit(*beg)) 
+        throw std::invalid_argument("parse_bed_int");
+    long long x = 0;
+    for (; beg < end && isdigit(*beg); beg++) {
+        x = x*10 + (*beg - '0');
+        if (x > 1LL + INT_MAX) throw std::out_of_range("parse_bed_int");
+    }
+    if (neg) x = -x;
+    if (x > INT_MAX || x < INT_MIN) throw std::out_of_range("parse_bed_int");
+    return x;
+}
 
 bedData::bedData(const std::string & bed_fn) {
 
-    // fail if file doesn't exist
-    auto bed_fp = fopen(bed_fn.data(), "r");
-    if (bed_fp == NULL) {
+    // tokenize file (mapped, or read if e.g. a pipe) in place, tab-separated
+    // contig, start, and stop
+    mappedFile bed(bed_fn);
+    if (bed.data == NULL) {
         ERROR("Failed to open BED file '%s'", bed_fn.data());
     }
-    fclose(bed_fp);
-
-    std::ifstream bed(bed_fn);
-    std::string region;
-    while (getline(bed, region)) {
-        std::stringstream ss(region);
-        std::string contig, start, stop;
-        getline(ss, contig, '\t');
-        getline(ss, start, '\t');
-        getline(ss, stop, '\t');
-        this->add(contig, std::stoi(start), std::stoi(stop));
+    const char * ptr = bed.data;
+    const char * file_end = bed.data + bed.size;
+    while (ptr < file_end) {
+        const char * line_end = (const char *) memchr(ptr, '\n', file_end - ptr);
+        if (line_end == NULL) line_end = file_end;
+        const char * begs[3] = {ptr, line_end, line_end};
+        const char * ends[3] = {line_end, line_end, line_end};
+        for (int f = 0; f < 3; f++) {
+            const char * tab = (const char *) memchr(
+                    begs[f], '\t', line_end - begs[f]);
+            if (tab == NULL) break;
+            ends[f] = tab;
+            if (f+1 < 3) begs[f+1] = tab + 1;
+        }
+        this->add(std::string(begs[0], ends[0] - begs[0]),
+                parse_bed_int(begs[1], ends[1]), parse_bed_int(begs[2], ends[2]));
+        ptr = line_end + 1;
     }
 }
 
 void bedData::add(const std::string & contig, const int & start, const int & stop) {
-    if (this->regions.find(contig) == this->regions.end()) {
-        this->regions[contig] = contigRegions();
-        this->contigs.push_back(contig);
-    }
-    this->regions[contig].starts.push_back(start);
-    this->regions[contig].stops.push_back(stop);
-    this->regions[contig].n++;
+    auto [itr, added] = this->regions.try_emplace(contig);
+    if (added) this->contigs.push_back(contig);
+    contigRegions & regions = itr->second;
+    regions.starts.push_back(start);
+    regions.stops.push_back(stop);
+    regions.n++;
     this->size += stop-start;
 }
 
 void bedData::check() {
     for (size_t i = 0; i < this->contigs.size(); i++) {
+        const contigRegions & regions = this->regions[this->contigs[i]];
         int prev_start = -1;
         int prev_stop = -1;
-        for (int j = 0; j < this->regions[this->contigs[i]].n; j++) {
+        for (int j = 0; j < regions.n; j++) {
 
             // check this region is positive size
-            int start = this->regions[this->contigs[i]].starts[j];
-            int stop = this->regions[this->contigs[i]].stops[j];
+            int start = regions.starts[j];
+            int stop = regions.stops[j];
             if (stop < start) ERROR("BED region %s:%d-%d stop precedes start.", 
                     this->contigs[i].data(), start, stop);
             if (stop == start) ERROR("BED region %s:%d-%d length zero.",
@@ -70,41 +102,68 @@ void bedData::check() {
     }
 }
 
-int bedData::contains(std::string contig, const int & start, const int & stop) {
+int bedData::contains(const std::string & contig, 
+        const int & start, const int & stop) const {
+    return this->cursor(contig).contains(start, stop);
+}
 
-    if (!g.bed_exists) return BED_INSIDE;
-
-    if (stop < start)
-        ERROR("Invalid region %s:%d-%d in BED contains", contig.data(), start, stop);
+/* Cursor over the regions of `contig`, for classifying its sorted variants. */
+bedCursor bedData::cursor(const std::string & contig) const {
+    if (!g.bed_exists) return bedCursor(NULL, BED_INSIDE);
 
     // contig not in BED
-    if (this->regions.find(contig) == this->regions.end()) return BED_OFFCTG;
+    auto itr = this->regions.find(contig);
+    if (itr == this->regions.end()) return bedCursor(NULL, BED_OFFCTG);
+    return bedCursor(&itr->second, BED_OUTSIDE);
+}
+
+/******************************************************************************/
+
+int bedCursor::contains(int start, int stop) {
+
+    if (this->regions == NULL) return this->no_regions_loc;
+
+    if (stop < start)
+        ERROR("Invalid region %d-%d in BED contains", start, stop);
 
     // variant before/after all BED regions
-    if (stop <= this->regions[contig].starts[0]) return BED_OUTSIDE;
-    if (start >= this->regions[contig].stops[ 
-            this->regions[contig].stops.size()-1]) return BED_OUTSIDE;
-
-    // get indices of variant within bed regions list
-    int start_idx = std::upper_bound(
-            this->regions[contig].starts.begin(),
-            this->regions[contig].starts.end(),
-            start) - this->regions[contig].starts.begin() - 1;
-    int stop_idx = std::lower_bound(
-            this->regions[contig].stops.begin(),
-            this->regions[contig].stops.end(),
-            stop) - this->regions[contig].stops.begin();
+    const std::vector<int> & starts = this->regions->starts;
+    const std::vector<int> & stops = this->regions->stops;
+    if (stop <= starts[0]) return BED_OUTSIDE;
+    if (start >= stops[stops.size()-1]) return BED_OUTSIDE;
+
+    // get indices of variant within bed regions list, advancing from the
+    // previous variant's (or searching, if this variant precedes it)
+    int n = stops.size();
+    if (start < this->prev_start) {
+        this->nstarts = std::upper_bound(starts.begin(), starts.end(), 
+                start) - starts.begin();
+    } else {
+        while (this->nstarts < n && starts[this->nstarts] <= start)
+            this->nstarts++;
+    }
+    if (stop < this->prev_stop) {
+        this->nstops = std::lower_bound(stops.begin(), stops.end(), 
+                stop) - stops.begin();
+    } else {
+        while (this->nstops < n && stops[this->nstops] < stop)
+            this->nstops++;
+    }
+    this->prev_start = start;
+    this->prev_stop = stop;
+    int start_idx = this->nstarts - 1;
+    int stop_idx = this->nstops;
 
     // variant must be partially in region, other index off end
     if (start_idx < 0) return BED_BORDER;
-    if (stop_idx >= int(this->regions[contig].stops.size())) return BED_BORDER;
+    if (stop_idx >= n) return BED_BORDER;
 
     // variant in middle
     if (stop_idx == start_idx)
         return BED_INSIDE;
     if (stop_idx == start_idx + 1) {
-        int next_region_start = this->regions[contig].starts[stop_idx];
-        int prev_region_stop = this->regions[contig].stops[start_idx];
+        int next_region_start = starts[stop_idx];
+        int prev_region_stop = stops[start_idx];
         if (start >= prev_region_stop && stop <= next_region_start) 
             return BED_OUTSIDE; // between
         return BED_BORDER; // both
@@ -135,135 +194,147 @@ void check_contigs(
     if (g.verbosity >= 1) INFO(" ");
     if (g.verbosity >= 1) INFO("  Checking contigs:");
 
+    // BED contig IDs (BED may include contigs not in any other input)
+    std::vector<int> bed_ctgs;
+    for (const std::string & ctg : g.bed.contigs)
+        bed_ctgs.push_back(ctg_dict.id(ctg));
+
     if (g.bed_exists) { // use BED to determine contigs
 
         // remove all extraneous contigs not in BED
-        std::vector<std::string>::iterator itr = query_ptr->contigs.begin();
+        std::vector<int>::iterator itr = query_ptr->contigs.begin();
         while (itr != query_ptr->contigs.end()) { // query
-            if (std::find(g.bed.contigs.begin(), g.bed.contigs.end(),
-                        *itr) == g.bed.contigs.end()) {
+            if (std::find(bed_ctgs.begin(), bed_ctgs.end(),
+                        *itr) == bed_ctgs.end()) {
                 query_ptr->lengths.erase(query_ptr->lengths.begin() + 
                         (itr - query_ptr->contigs.begin()));
-                query_ptr->ctg_variants[HAP1].erase(*itr);
-                query_ptr->ctg_variants[HAP2].erase(*itr);
-                itr = query_ptr->contigs.erase(itr);
+                query_ptr->ploidy.erase(query_ptr->ploidy.begin() + 
+                        (itr - query_ptr->contigs.begin()));
+                query_ptr->ctg_variants[HAP1][*itr] = nullptr;
+                query_ptr->ctg_variants[HAP2][*itr] = nullptr;
                 if (g.verbosity >= 2) 
-                    WARN("Ignoring %s from QUERY VCF, not in BED file.", (*itr).data());
+                    WARN("Ignoring %s from QUERY VCF, not in BED file.", 
+                            ctg_dict.name(*itr).data());
+                itr = query_ptr->contigs.erase(itr);
             } else itr++;
         }
         itr = truth_ptr->contigs.begin();
         while (itr != truth_ptr->contigs.end()) { // truth
-            if (std::find(g.bed.contigs.begin(), g.bed.contigs.end(),
-                        *itr) == g.bed.contigs.end()) {
+            if (std::find(bed_ctgs.begin(), bed_ctgs.end(),
+                        *itr) == bed_ctgs.end()) {
                 truth_ptr->lengths.erase(truth_ptr->lengths.begin() + 
                         (itr - truth_ptr->contigs.begin()));
-                truth_ptr->ctg_variants[HAP1].erase(*itr);
-                truth_ptr->ctg_variants[HAP2].erase(*itr);
-                itr = truth_ptr->contigs.erase(itr);
+                truth_ptr->ploidy.erase(truth_ptr->ploidy.begin() + 
+                        (itr - truth_ptr->contigs.begin()));
+                truth_ptr->ctg_variants[HAP1][*itr] = nullptr;
+                truth_ptr->ctg_variants[HAP2][*itr] = nullptr;
                 if (g.verbosity >= 2) 
-                    WARN("Ignoring %s from TRUTH VCF, not in BED file.", (*itr).data());
+                    WARN("Ignoring %s from TRUTH VCF, not in BED file.", 
+                            ctg_dict.name(*itr).data());
+                itr = truth_ptr->contigs.erase(itr);
             } else itr++;
         }
-        auto itr2 = ref_ptr->fasta.begin();
-        while (itr2 != ref_ptr->fasta.end()) { // fasta
-            if (std::find(g.bed.contigs.begin(), g.bed.contigs.end(),
-                        itr2->first) == g.bed.contigs.end()) {
-                itr2 = ref_ptr->fasta.erase(itr2);
-            } else itr2++;
+        for (int ctg = 0; ctg < int(ref_ptr->fasta.size()); ctg++) { // fasta
+            if (std::find(bed_ctgs.begin(), bed_ctgs.end(), ctg) == bed_ctgs.end())
+                ref_ptr->erase(ctg);
         }
 
         // warn if list of truth and query contigs are not the same
-        for (std::string ctg : query_ptr->contigs) {
+        for (int ctg : query_ptr->contigs) {
             if (std::find(truth_ptr->contigs.begin(), 
                         truth_ptr->contigs.end(), ctg) == truth_ptr->contigs.end())
-                WARN("Contig '%s' found in query VCF but not truth VCF.", ctg.data());
+                WARN("Contig '%s' found in query VCF but not truth VCF.", 
+                        ctg_dict.name(ctg).data());
         }
-        for (std::string ctg : truth_ptr->contigs) {
+        for (int ctg : truth_ptr->contigs) {
             if (std::find(query_ptr->contigs.begin(), 
                         query_ptr->contigs.end(), ctg) == query_ptr->contigs.end())
-                WARN("Contig '%s' found in truth VCF but not query VCF.", ctg.data());
+                WARN("Contig '%s' found in truth VCF but not query VCF.", 
+                        ctg_dict.name(ctg).data());
         }
 
         // ensure all inputs contain required contigs (even if empty)
-        for (std::string ctg : g.bed.contigs) {
-            if (ref_ptr->fasta.find(ctg) == ref_ptr->fasta.end())
-                ERROR("Contig '%s' found in BED but not reference FASTA.", ctg.data());
+        for (int ctg : bed_ctgs) {
+            if (!ref_ptr->contains(ctg))
+                ERROR("Contig '%s' found in BED but not reference FASTA.", 
+                        ctg_dict.name(ctg).data());
             if (std::find(query_ptr->contigs.begin(), 
                         query_ptr->contigs.end(), ctg) == query_ptr->contigs.end()) {
-                INFO("Contig '%s' found in BED but not query VCF.", ctg.data());
-                query_ptr->ctg_variants[HAP1][ctg] = 
-                        std::shared_ptr<ctgVariants>(new ctgVariants());
-                query_ptr->ctg_variants[HAP2][ctg] = 
-                        std::shared_ptr<ctgVariants>(new ctgVariants());
+                INFO("Contig '%s' found in BED but not query VCF.", 
+                        ctg_dict.name(ctg).data());
+                query_ptr->init_ctg(ctg);
                 query_ptr->contigs.push_back(ctg);
                 query_ptr->lengths.push_back(ref_ptr->lengths.at(ctg));
+                query_ptr->ploidy.push_back(0); // unknown, no variants
             }
             if (std::find(truth_ptr->contigs.begin(), 
                         truth_ptr->contigs.end(), ctg) == truth_ptr->contigs.end()) {
-                INFO("Contig '%s' found in BED but not truth VCF.", ctg.data());
-                truth_ptr->ctg_variants[HAP1][ctg] = 
-                        std::shared_ptr<ctgVariants>(new ctgVariants());
-                truth_ptr->ctg_variants[HAP2][ctg] = 
-                        std::shared_ptr<ctgVariants>(new ctgVariants());
+                INFO("Contig '%s' found in BED but not truth VCF.", 
+                        ctg_dict.name(ctg).data());
+                truth_ptr->init_ctg(ctg);
                 truth_ptr->contigs.push_back(ctg);
                 truth_ptr->lengths.push_back(ref_ptr->lengths.at(ctg));
+                truth_ptr->ploidy.push_back(0); // unknown, no variants
             }
         }
 
     } else { // use truth VCF to determine contigs
 
         // ensure fasta contains all contigs
-        for (std::string ctg : truth_ptr->contigs) {
-            if (ref_ptr->fasta.find(ctg) == ref_ptr->fasta.end())
-                ERROR("Contig '%s' found in truth VCF but not reference FASTA. Please provide BED file.", ctg.data());
+        for (int ctg : truth_ptr->contigs) {
+            if (!ref_ptr->contains(ctg))
+                ERROR("Contig '%s' found in truth VCF but not reference FASTA. Please provide BED file.", 
+                        ctg_dict.name(ctg).data());
         }
 
         // remove all extraneous contigs
-        std::vector<std::string>::iterator itr = query_ptr->contigs.begin();
+        std::vector<int>::iterator itr = query_ptr->contigs.begin();
         while (itr != query_ptr->contigs.end()) { // query
             if (std::find(truth_ptr->contigs.begin(), truth_ptr->contigs.end(),
                         *itr) == truth_ptr->contigs.end()) {
-                ERROR("Contig '%s' found in query VCF but not truth VCF. Please provide BED file.", (*itr).data());
+                ERROR("Contig '%s' found in query VCF but not truth VCF. Please provide BED file.", 
+                        ctg_dict.name(*itr).data());
                 query_ptr->lengths.erase(query_ptr->lengths.begin() + 
                         (itr - query_ptr->contigs.begin()));
-                query_ptr->ctg_variants[HAP1].erase(*itr);
-                query_ptr->ctg_variants[HAP2].erase(*itr);
+                query_ptr->ploidy.erase(query_ptr->ploidy.begin() + 
+                        (itr - query_ptr->contigs.begin()));
+                query_ptr->ctg_variants[HAP1][*itr] = nullptr;
+                query_ptr->ctg_variants[HAP2][*itr] = nullptr;
                 itr = query_ptr->contigs.erase(itr);
             } else itr++;
         }
-        auto itr2 = ref_ptr->fasta.begin();
-        while (itr2 != ref_ptr->fasta.end()) { // fasta
+        for (int ctg = 0; ctg < int(ref_ptr->fasta.size()); ctg++) { // fasta
             if (std::find(truth_ptr->contigs.begin(), truth_ptr->contigs.end(),
-                        itr2->first) == truth_ptr->contigs.end()) {
-                itr2 = ref_ptr->fasta.erase(itr2);
-            } else itr2++;
+                        ctg) == truth_ptr->contigs.end())
+                ref_ptr->erase(ctg);
         }
 
         // ensure all inputs contain required contigs (even if empty)
-        for (std::string ctg : truth_ptr->contigs) {
+        for (int ctg : truth_ptr->contigs) {
             if (std::find(query_ptr->contigs.begin(), 
                         query_ptr->contigs.end(), ctg) == query_ptr->contigs.end()) {
-                WARN("Contig '%s' found in truth VCF but not query VCF.", ctg.data());
-                query_ptr->ctg_variants[HAP1][ctg] = 
-                        std::shared_ptr<ctgVariants>(new ctgVariants());
-                query_ptr->ctg_variants[HAP2][ctg] = 
-                        std::shared_ptr<ctgVariants>(new ctgVariants());
+                WARN("Contig '%s' found in truth VCF but not query VCF.", 
+                        ctg_dict.name(ctg).data());
+                query_ptr->init_ctg(ctg);
                 query_ptr->contigs.push_back(ctg);
                 query_ptr->lengths.push_back(ref_ptr->lengths.at(ctg));
+                query_ptr->ploidy.push_back(0); // unknown, no variants
             }
         }
     }
 
     // verify ploidy matches for all truth/query contigs
     for (int i = 0; i < int(truth_ptr->contigs.size()); i++) {
-        std::string ctg = truth_ptr->contigs[i];
+        int ctg = truth_ptr->contigs[i];
         int query_ctg_idx = std::find(query_ptr->contigs.begin(), 
                 query_ptr->contigs.end(), ctg) - query_ptr->contigs.begin();
         int truth_ctg_idx = i;
-        if (truth_ptr->ploidy[truth_ctg_idx] != query_ptr->ploidy[query_ctg_idx]) {
+        if (truth_ptr->ploidy[truth_ctg_idx] && query_ptr->ploidy[query_ctg_idx] &&
+                truth_ptr->ploidy[truth_ctg_idx] != query_ptr->ploidy[query_ctg_idx]) {
             WARN("%s contig '%s' has ploidy %d and %s contig '%s' has ploidy %d",
-                    callset_strs[TRUTH].data(), ctg.data(), truth_ptr->ploidy[truth_ctg_idx],
-                    callset_strs[QUERY].data(), ctg.data(), query_ptr->ploidy[query_ctg_idx]);
+                    callset_strs[TRUTH].data(), ctg_dict.name(ctg).data(), 
+                    truth_ptr->ploidy[truth_ctg_idx], callset_strs[QUERY].data(), 
+                    ctg_dict.name(ctg).data(), query_ptr->ploidy[query_ctg_idx]);
         }
     }
 
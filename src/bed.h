@@ -7,15 +7,39 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <memory>
 
 #include "defs.h"
 #include "fasta.h"
-#include "variant.h"
+
+class variantData;
 
 struct contigRegions {
     std::vector<int> starts;
     std::vector<int> stops;
-    int n;
+    int n = 0;
+};
+
+/* Classifies variants against the sorted BED regions of one contig. Variants
+ * are expected in (mostly) increasing order, so the region indices bounding 
+ * each variant are found by advancing from those of the previous variant, 
+ * one linear pass per contig. Out-of-order variants fall back to a binary 
+ * search, giving the same result.
+ */
+class bedCursor {
+public:
+    bedCursor(const contigRegions * regions, int no_regions_loc) : 
+        regions(regions), no_regions_loc(no_regions_loc) {;}
+
+    int contains(int start, int stop);
+
+private:
+    const contigRegions * regions;   // NULL if contig has no regions
+    int no_regions_loc;              // BED location without regions
+    int nstarts = 0;                 // regions starting at or before prev_start
+    int nstops = 0;                  // regions ending before prev_stop
+    int prev_start = 0;
+    int prev_stop = 0;
 };
 
 class bedData {
@@ -27,7 +51,8 @@ public:
 
     void add(const std::string & contig, const int & start, const int & stop);
     void check();
-    int contains(std::string contig, const int & start, const int & stop);
+    int contains(const std::string & contig, const int & start, const int & stop) const;
+    bedCursor cursor(const std::string & contig) const;
 
     operator std::string() const;
 
@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <string>
+#include <immintrin.h>
+
+#include "dist.h"
+
+/* Microbenchmark for extend_match() (dist.h), against the alternatives it 
+ * was chosen over. Each candidate finds the length of the common prefix of a
+ * and b (up to limit). A 1 Mbase random sequence is compared against a copy 
+ * with substitutions at geometric intervals, so the mean run length controls
+ * how far each call gets before the first mismatch.
+ *
+ *     make bench_extend && ./bench_extend
+ */
+
+int extend_byte(const char * a, const char * b, int limit) {
+    int len = 0;
+    while (len < limit && a[len] == b[len]) len++;
+    return len;
+}
+
+int extend_word(const char * a, const char * b, int limit) { // previous match_len()
+    int len = 0;
+    uint64_t wa, wb;
+    for (; len + 8 <= limit; len += 8) {
+        memcpy(&wa, a + len, 8);
+        memcpy(&wb, b + len, 8);
+        if (wa != wb) return len + __builtin_ctzll(wa ^ wb) / 8;
+    }
+    while (len < limit && a[len] == b[len]) len++;
+    return len;
+}
+
+int extend_sse2(const char * a, const char * b, int limit) { // 16 bytes only
+    int len = 0;
+    uint64_t wa, wb;
+    for (; len + 16 <= limit; len += 16) {
+        unsigned mask = 0xFFFF ^ _mm_movemask_epi8(_mm_cmpeq_epi8(
+                _mm_loadu_si128((const __m128i *) (a + len)),
+                _mm_loadu_si128((const __m128i *) (b + len))));
+        if (mask) return len + __builtin_ctz(mask);
+    }
+    for (; len + 8 <= limit; len += 8) {
+        memcpy(&wa, a + len, 8);
+        memcpy(&wb, b + len, 8);
+        if (wa != wb) return len + __builtin_ctzll(wa ^ wb) / 8;
+    }
+    while (len < limit && a[len] == b[len]) len++;
+    return len;
+}
+
+__attribute__((target("avx2")))
+int extend_avx2(const char * a, const char * b, int limit) {
+    int len = 0;
+    uint64_t wa, wb;
+    for (; len + 32 <= limit; len += 32) {
+        unsigned mask = ~(unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i *) (a + len)),
+                _mm256_loadu_si256((const __m256i *) (b + len))));
+        if (mask) return len + __builtin_ctz(mask);
+    }
+    for (; len + 8 <= limit; len += 8) {
+        memcpy(&wa, a + len, 8);
+        memcpy(&wb, b + len, 8);
+        if (wa != wb) return len + __builtin_ctzll(wa ^ wb) / 8;
+    }
+    while (len < limit && a[len] == b[len]) len++;
+    return len;
+}
+
+int extend_fwd(const char * a, const char * b, int limit) { // as shipped
+    return extend_match(seqView(std::string_view(a, limit)), 0,
+            seqView(std::string_view(b, limit)), 0, limit);
+}
+
+template <typename F>
+void bench(const char * name, F extend, int mean_run, int reps) {
+    std::mt19937 rng(1);
+    std::string a(1 << 20, 'A');
+    for (char & c : a) c = "ACGT"[rng() % 4];
+    std::string b = a;
+    std::geometric_distribution<int> gap(1.0 / mean_run);
+    for (int i = gap(rng); i < int(b.size()); i += gap(rng) + 1)
+        b[i] = b[i] == 'A' ? 'C' : 'A';
+
+    long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < reps; rep++) {
+        for (int i = 0; i < int(a.size())-1; ) {
+            int len = extend(a.data()+i, b.data()+i, int(a.size())-i);
+            total += len;
+            i += len + 1;
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+    printf("%-7s mean run %4d: %8.1f ms  (matched %ld)\n", 
+            name, mean_run, ms, total);
+}
+
+int main() {
+    const int reps = 50;
+    bool avx2 = __builtin_cpu_supports("avx2");
+    for (int mean_run : {2, 8, 32, 200}) {
+        bench("byte", extend_byte, mean_run, reps);
+        bench("word", extend_word, mean_run, reps);
+        bench("sse2", extend_sse2, mean_run, reps);
+        if (avx2) bench("avx2", extend_avx2, mean_run, reps);
+        bench("extend", extend_fwd, mean_run, reps);
+        printf("\n");
+    }
+    return 0;
+}
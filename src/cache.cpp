@@ -0,0 +1,236 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "cache.h"
+#include "globals.h"
+#include "print.h"
+
+const char VDC_MAGIC[4] = {'V', 'D', 'C', '\0'};
+
+/******************************************************************************/
+
+/* 64-bit FNV-1a hash, stable across runs and platforms. */
+uint64_t fnv1a(const void * data, size_t size,
+        uint64_t hash = 14695981039346656037ULL) {
+    const unsigned char * bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* Canonical path, size and modification time of a file, as a cache key. */
+std::string file_stamp(const std::string & fn) {
+    try {
+        std::filesystem::path path = std::filesystem::canonical(fn);
+        return path.string() + " " +
+            std::to_string(std::filesystem::file_size(path)) + " " +
+            std::to_string(std::filesystem::last_write_time(path)
+                    .time_since_epoch().count()) + " ";
+    } catch (const std::exception & e) {
+        ERROR("%s", e.what());
+    }
+    return "";
+}
+
+/* The cache key covers the callset's VCF, the BED and the reference FASTA
+ * (each by path, size and modification time, so no input is read), and all
+ * parameters used while parsing, clustering and realigning. Each sample of a
+ * multi-sample VCF is cached separately.
+ */
+std::vector<std::string> cache_filenames(int callset,
+        const std::vector<std::string> & samples) {
+    std::string params = std::to_string(VDC_VERSION) + " " +
+        callset_strs[callset] + " " +
+        std::to_string(g.min_qual) + " " + std::to_string(g.max_qual) + " " +
+        std::to_string(g.min_size) + " " + std::to_string(g.max_size) + " " +
+        std::to_string(g.cluster_min_gap) + " " +
+        std::to_string(g.reach_min_gap) + " " +
+        std::to_string(g.max_cluster_itrs) + " " +
+        std::to_string(g.simple_cluster) + " ";
+    if (callset == QUERY) {
+        params += std::to_string(g.keep_query) + " " +
+            std::to_string(g.query_sub) + " " + std::to_string(g.query_open) +
+            " " + std::to_string(g.query_extend) + " ";
+    } else {
+        params += std::to_string(g.keep_truth) + " " +
+            std::to_string(g.truth_sub) + " " + std::to_string(g.truth_open) +
+            " " + std::to_string(g.truth_extend) + " ";
+    }
+    params += file_stamp(g.ref_fasta_fn);
+    if (g.bed_exists) params += file_stamp(g.bed_fn);
+    params += file_stamp(callset == QUERY ? g.query_vcf_fn : g.truth_vcf_fn);
+    uint64_t hash = fnv1a(params.data(), params.size());
+
+    std::vector<std::string> cache_fns;
+    std::string name = callset == QUERY ? "query" : "truth";
+    for (const std::string & sample : samples) {
+        char key[17];
+        snprintf(key, sizeof(key), "%016llx", (unsigned long long) 
+                fnv1a(sample.data(), sample.size(), hash));
+        cache_fns.push_back(g.cache_dir + "/" + name + "-" + key + ".vdc");
+    }
+    return cache_fns;
+}
+
+/******************************************************************************/
+
+/* Save a parsed, clustered and realigned callset, along with the contents of
+ * its `orig` VCF written before preprocessing. Contigs without variants are
+ * omitted, since check_contigs() re-adds them as required.
+ */
+void save_cache(const std::string & cache_fn,
+        std::shared_ptr<variantData> vcf, const std::string & orig_vcf_fn) {
+    if (g.verbosity >= 1) INFO("  Saving %s VCF to cache '%s'",
+            callset_strs[vcf->callset].data(), cache_fn.data());
+
+    std::vector<int> ctg_idxs;
+    for (int i = 0; i < int(vcf->contigs.size()); i++) {
+        if (vcf->ctg_variants[HAP1][vcf->contigs[i]]->n ||
+                vcf->ctg_variants[HAP2][vcf->contigs[i]]->n)
+            ctg_idxs.push_back(i);
+    }
+
+    mappedFile orig(orig_vcf_fn);
+    if (orig.data == NULL)
+        ERROR("Failed to read '%s' for cache", orig_vcf_fn.data());
+
+    fileWriter out(cache_fn);
+    out.write(VDC_MAGIC, sizeof(VDC_MAGIC));
+    out.write_int(VDC_VERSION);
+    uint64_t orig_size = orig.size;
+    out.write(&orig_size, sizeof(orig_size));
+    out.write(orig.data, orig.size);
+    out.write_str(vcf->filename);
+    out.write_str(vcf->sample);
+    out.write_int(ctg_idxs.size());
+    for (int i : ctg_idxs) {
+        out.write_str(ctg_dict.name(vcf->contigs[i]));
+        out.write_int(vcf->lengths[i]);
+        out.write_int(vcf->ploidy[i]);
+        for (int hap = 0; hap < HAPS; hap++) {
+            std::shared_ptr<ctgVariants> vars =
+                vcf->ctg_variants[hap][vcf->contigs[i]];
+            out.write_int(vars->n);
+            out.write_vector(vars->poss);
+            out.write_vector(vars->rlens);
+            out.write_vector(vars->haps);
+            out.write_vector(vars->types);
+            out.write_vector(vars->locs);
+            out.write_vector(vars->orig_gts);
+            out.write_vector(vars->gt_quals);
+            out.write_vector(vars->var_quals);
+            out.write_vector(vars->allele_offs);
+            out.write_vector(vars->ref_lens);
+            out.write_vector(vars->alt_lens);
+            out.write_str(vars->alleles);
+            out.write_int(vars->clusters.size());
+            out.write_vector(vars->clusters);
+        }
+    }
+    out.close();
+}
+
+/* Load a preprocessed callset, or return nullptr if it isn't cached. */
+std::shared_ptr<variantData> load_cache(
+        const std::string & cache_fn, int callset) {
+
+    mappedFile in(cache_fn);
+    if (in.data == NULL) return nullptr;
+
+    char magic[sizeof(VDC_MAGIC)];
+    int version = 0;
+    if (!in.read(magic, sizeof(magic)) ||
+            memcmp(magic, VDC_MAGIC, sizeof(VDC_MAGIC)) != 0 ||
+            !in.read_int(version) || version != VDC_VERSION) {
+        WARN("Ignoring invalid cache file '%s'", cache_fn.data());
+        return nullptr;
+    }
+
+    if (g.verbosity >= 1) INFO(" ");
+    if (g.verbosity >= 1) INFO("%s[%s 0/8] Loading cached %s VCF%s '%s'",
+            COLOR_PURPLE, callset == QUERY ? "Q" : "T",
+            callset_strs[callset].data(), COLOR_WHITE, cache_fn.data());
+
+    std::shared_ptr<variantData> vcf(new variantData());
+    vcf->callset = callset;
+    uint64_t orig_size = 0;
+    bool ok = in.read(&orig_size, sizeof(orig_size)) && 
+            orig_size <= in.size - in.pos;
+    if (ok) in.pos += orig_size; // see write_cached_vcf()
+    int nctg = 0;
+    ok = ok && in.read_str(vcf->filename) && in.read_str(vcf->sample) &&
+            in.read_int(nctg) && nctg >= 0;
+    for (int i = 0; ok && i < nctg; i++) {
+        std::string ctg_name;
+        int length = 0, ploidy = 0;
+        ok = in.read_str(ctg_name) && in.read_int(length) && in.read_int(ploidy);
+        int ctg = ctg_dict.id(ctg_name);
+        vcf->init_ctg(ctg);
+        vcf->contigs.push_back(ctg);
+        vcf->lengths.push_back(length);
+        vcf->ploidy.push_back(ploidy);
+        for (int hap = 0; ok && hap < HAPS; hap++) {
+            std::shared_ptr<ctgVariants> vars(new ctgVariants());
+            int n = 0, nclusters = 0;
+            ok = in.read_int(n) &&
+                in.read_vector(vars->poss, n) &&
+                in.read_vector(vars->rlens, n) &&
+                in.read_vector(vars->haps, n) &&
+                in.read_vector(vars->types, n) &&
+                in.read_vector(vars->locs, n) &&
+                in.read_vector(vars->orig_gts, n) &&
+                in.read_vector(vars->gt_quals, n) &&
+                in.read_vector(vars->var_quals, n) &&
+                in.read_vector(vars->allele_offs, n) &&
+                in.read_vector(vars->ref_lens, n) &&
+                in.read_vector(vars->alt_lens, n) &&
+                in.read_str(vars->alleles) &&
+                in.read_int(nclusters) &&
+                in.read_vector(vars->clusters, nclusters);
+            for (int j = 0; ok && j < n; j++) // alleles within pool
+                ok = vars->allele_offs[j] >= 0 && vars->ref_lens[j] >= 0 &&
+                    vars->alt_lens[j] >= 0 && size_t(vars->allele_offs[j]) +
+                    vars->ref_lens[j] + vars->alt_lens[j] <= vars->alleles.size();
+            vars->n = n;
+            vars->errtypes.assign(std::max(n, 0), ERRTYPE_UN);
+            vars->credit.assign(std::max(n, 0), 0);
+            vars->callq.assign(std::max(n, 0), 0);
+            vcf->ctg_variants[hap][ctg] = vars;
+        }
+    }
+    if (!ok || in.pos != in.size) {
+        WARN("Ignoring truncated cache file '%s'", cache_fn.data());
+        return nullptr;
+    }
+    return vcf;
+}
+
+/* Load every sample of a callset, or return an empty list unless all are cached. */
+std::vector< std::shared_ptr<variantData> > load_caches(
+        const std::vector<std::string> & cache_fns, int callset) {
+    std::vector< std::shared_ptr<variantData> > vcfs;
+    for (const std::string & cache_fn : cache_fns) {
+        std::shared_ptr<variantData> vcf = load_cache(cache_fn, callset);
+        if (vcf == nullptr) return {};
+        vcfs.push_back(vcf);
+    }
+    return vcfs;
+}
+
+/* Write the `orig` VCF saved with a (previously loaded) cache to `out_vcf_fn`. */
+void write_cached_vcf(const std::string & cache_fn, const std::string & out_vcf_fn) {
+    mappedFile in(cache_fn);
+    uint64_t orig_size = 0;
+    in.pos = sizeof(VDC_MAGIC) + sizeof(int);
+    if (!in.read(&orig_size, sizeof(orig_size)) || orig_size > in.size - in.pos)
+        ERROR("Failed to read cache file '%s'", cache_fn.data());
+    FILE* out_vcf = fopen(out_vcf_fn.data(), "w");
+    if (out_vcf == NULL)
+        ERROR("Failed to open output file '%s'", out_vcf_fn.data());
+    if (fwrite(in.data + in.pos, 1, orig_size, out_vcf) != orig_size)
+        ERROR("Failed to write output file '%s'", out_vcf_fn.data());
+    fclose(out_vcf);
+}
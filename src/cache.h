@@ -0,0 +1,25 @@
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "variant.h"
+#include "file.h"
+#include "defs.h"
+
+// bump whenever the serialized layout or preprocessing results change
+#define VDC_VERSION 3
+
+std::vector<std::string> cache_filenames(int callset,
+        const std::vector<std::string> & samples);
+std::shared_ptr<variantData> load_cache(
+        const std::string & cache_fn, int callset);
+std::vector< std::shared_ptr<variantData> > load_caches(
+        const std::vector<std::string> & cache_fns, int callset);
+void save_cache(const std::string & cache_fn,
+        std::shared_ptr<variantData> vcf, const std::string & orig_vcf_fn);
+void write_cached_vcf(const std::string & cache_fn, const std::string & out_vcf_fn);
+
+#endif
@@ -43,7 +43,7 @@ sort_superclusters(std::shared_ptr<superclusterData> sc_data) {
             std::vector< std::vector<int> >(2));
 
     for (int ctg_idx = 0; ctg_idx < int(sc_data->contigs.size()); ctg_idx++) {
-        std::string ctg = sc_data->contigs[ctg_idx];
+        int ctg = sc_data->contigs[ctg_idx];
         auto ctg_scs = sc_data->ctg_superclusters[ctg];
         for (int sc_idx = 0; sc_idx < ctg_scs->n; sc_idx++) {
             int max_query_len = 0;
@@ -62,7 +62,7 @@ sort_superclusters(std::shared_ptr<superclusterData> sc_data) {
                 // calculate query len after applying variants
                 int query_len = ctg_scs->ends[sc_idx] - ctg_scs->begs[sc_idx];
                 for (int var = var_beg; var < var_end; var++) {
-                    query_len += (vars->alts[var].size() - vars->refs[var].size());
+                    query_len += (vars->alt_lens[var] - vars->ref_lens[var]);
                 }
                 max_query_len = std::max(max_query_len, query_len);
             }
@@ -79,7 +79,7 @@ sort_superclusters(std::shared_ptr<superclusterData> sc_data) {
                 // calculate truth len after applying variants
                 int truth_len = ctg_scs->ends[sc_idx] - ctg_scs->begs[sc_idx];
                 for (int var = var_beg; var < var_end; var++) {
-                    truth_len += (vars->alts[var].size() - vars->refs[var].size());
+                    truth_len += (vars->alt_lens[var] - vars->ref_lens[var]);
                 }
                 max_truth_len = std::max(max_truth_len, truth_len);
             }
@@ -94,7 +94,8 @@ sort_superclusters(std::shared_ptr<superclusterData> sc_data) {
             double mem_gb = mem / (1000.0 * 1000.0 * 1000.0);
             if (mem_gb > g.max_ram) {
                 WARN("Max (%.3fGB) RAM exceeded (%.3fGB req) for supercluster %s:%d-%d, running anyways", 
-                        g.max_ram, mem_gb, ctg.data(), ctg_scs->begs[sc_idx], ctg_scs->ends[sc_idx]);
+                        g.max_ram, mem_gb, ctg_dict.name(ctg).data(), 
+                        ctg_scs->begs[sc_idx], ctg_scs->ends[sc_idx]);
                 sc_groups[g.thread_nsteps-1][CTG_IDX].push_back(ctg_idx);
                 sc_groups[g.thread_nsteps-1][SC_IDX].push_back(sc_idx);
                 continue;
@@ -123,10 +124,11 @@ superclusterData::superclusterData(
 
     // set reference pointer
     this->ref = ref_ptr;
+    this->ctg_superclusters.resize(ctg_dict.size(), nullptr);
 
     // create list of all contigs covered by truth/query
     for (int i = 0; i < int(query_ptr->contigs.size()); i++) {
-        std::string ctg = query_ptr->contigs[i];
+        int ctg = query_ptr->contigs[i];
         if (std::find(this->contigs.begin(), this->contigs.end(), ctg) == 
                 this->contigs.end()) {
             this->contigs.push_back(ctg);
@@ -137,7 +139,7 @@ superclusterData::superclusterData(
         }
     }
     for (int i = 0; i < int(truth_ptr->contigs.size()); i++) {
-        std::string ctg = truth_ptr->contigs[i];
+        int ctg = truth_ptr->contigs[i];
         if (std::find(this->contigs.begin(), this->contigs.end(), ctg) == 
                 this->contigs.end()) {
             this->contigs.push_back(ctg);
@@ -149,22 +151,22 @@ superclusterData::superclusterData(
     }
 
     // set pointers to variant lists (per contig)
-    for (std::string ctg : this->contigs) {
+    for (int ctg : this->contigs) {
         try {
             this->ctg_superclusters[ctg]->ctg_variants[QUERY][HAP1] = 
-                    query_ptr->ctg_variants[HAP1][ctg];
+                    query_ptr->ctg_variants[HAP1].at(ctg);
             this->ctg_superclusters[ctg]->ctg_variants[QUERY][HAP2] = 
-                    query_ptr->ctg_variants[HAP2][ctg];
+                    query_ptr->ctg_variants[HAP2].at(ctg);
         } catch (const std::exception & e) {
-            ERROR("Query VCF does not contain contig '%s'", ctg.data());
+            ERROR("Query VCF does not contain contig '%s'", ctg_dict.name(ctg).data());
         }
         try {
             this->ctg_superclusters[ctg]->ctg_variants[TRUTH][HAP1] = 
-                    truth_ptr->ctg_variants[HAP1][ctg];
+                    truth_ptr->ctg_variants[HAP1].at(ctg);
             this->ctg_superclusters[ctg]->ctg_variants[TRUTH][HAP2] = 
-                    truth_ptr->ctg_variants[HAP2][ctg];
+                    truth_ptr->ctg_variants[HAP2].at(ctg);
         } catch (const std::exception & e) {
-            ERROR("Truth VCF does not contain contig '%s'", ctg.data());
+            ERROR("Truth VCF does not contain contig '%s'", ctg_dict.name(ctg).data());
         }
     }
 
@@ -187,7 +189,7 @@ void superclusterData::gap_supercluster() {
     int total_vars = 0;
     int most_vars = 0;
     int total_bases = 0;
-    for (std::string ctg : this->contigs) {
+    for (int ctg : this->contigs) {
 
         // skip empty contigs
         int nvars = 0;
@@ -321,7 +323,7 @@ void gap_cluster(std::shared_ptr<variantData> vcf, int callset) {
     // cluster each contig
     int largest_cluster_vars = 0;
     int largest_cluster_bases = 0;
-    for (std::string ctg : vcf->contigs) {
+    for (int ctg : vcf->contigs) {
 
         // cluster per-haplotype variants: vcf->ctg_variants[hap]
         for (int hap = 0; hap < HAPS; hap++) {
@@ -359,7 +361,7 @@ void gap_cluster(std::shared_ptr<variantData> vcf, int callset) {
 /* Add single-VCF cluster indices to `variantData`. This version assumes that
  * all variant calls are true positives (doesn't allow skipping)
  */
-void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
+void wf_swg_cluster(variantData * vcf, int ctg, int hap,
         int sub, int open, int extend) {
 
     // allocate this memory once, use on each cluster
@@ -435,10 +437,10 @@ void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
             /*         printf("    %s %d %s %s var:%d\n", */
             /*                 ctg.data(), */ 
             /*                 vars->poss[var_idx], */
-            /*                 vars->refs[var_idx].size() ? */ 
-            /*                     vars->refs[var_idx].data() : "_", */
-            /*                 vars->alts[var_idx].size() ? */ 
-            /*                     vars->alts[var_idx].data() : "_", */
+            /*                 vars->ref_lens[var_idx] ? */ 
+            /*                     vars->ref(var_idx).data() : "_", */
+            /*                 vars->alt_lens[var_idx] ? */ 
+            /*                     vars->alt(var_idx).data() : "_", */
             /*                 var_idx */
             /*         ); */
             /*     } */
@@ -454,7 +456,8 @@ void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
             // LEFT REACH 
 
             if (left_compute) { // calculate left reach
-                std::string query, ref;
+                std::string query;
+                std::string_view ref;
 
                 // error checking
                 if (vars->clusters[clust]-1 < 0)
@@ -478,7 +481,7 @@ void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
                 int main_diag = 0;
                 for (int vi = vars->clusters[clust];
                         vi < vars->clusters[clust+1]; vi++)
-                    main_diag += vars->refs[vi].size() - vars->alts[vi].size();
+                    main_diag += vars->ref_lens[vi] - vars->alt_lens[vi];
 
                 // calculate max reaching path to left
                 int ref_len = score/extend + 3;
@@ -490,16 +493,15 @@ void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
                                 vars->clusters[clust], 
                                 vars->clusters[clust+1], 
                                 beg_pos, end_pos);
-                    ref = vcf->ref->fasta.at(ctg).substr(end_pos-ref_len, ref_len);
-                    std::reverse(query.begin(), query.end());
-                    std::reverse(ref.begin(), ref.end());
+                    ref = vcf->ref->seq(ctg).substr(end_pos-ref_len, ref_len);
                     // manage buffer for storing offsets
                     size_t offs_size = MATS * (std::max(open+extend, sub)+1) * 
                         (query.size() + ref.size() - 1);
                     if (offs_size > offs_buffer.size())
                         offs_buffer.resize(offs_size, -2);
                     // calculate reach
-                    reach = wf_swg_max_reach(query, ref, offs_buffer,
+                    reach = wf_swg_max_reach(seqView(query, true), 
+                            seqView(ref, true), offs_buffer,
                             main_diag, main_diag_start, score,
                             sub, open, extend, 
                             false /* print */, true  /* reverse */);
@@ -511,7 +513,7 @@ void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
                 l_reach = end_pos - reach;
 
                 if (false) {
-                    printf("REF:        %s\n", ref.data());
+                    printf("REF:        %.*s\n", int(ref.size()), ref.data());
                     printf("QUERY:      %s\n", query.data());
                     printf(" main diag:  %d\n", main_diag);
                     printf("diag start:  %d\n\n", main_diag_start);
@@ -528,7 +530,8 @@ void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
 
             // RIGHT REACH
             if (right_compute) { // calculate right reach
-                std::string query, ref;
+                std::string query;
+                std::string_view ref;
 
                 // error checking
                 if (vars->clusters[clust] < 0)
@@ -552,7 +555,7 @@ void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
                 int main_diag = 0;
                 for (int vi = vars->clusters[clust];
                         vi < vars->clusters[clust+1]; vi++)
-                    main_diag += vars->refs[vi].size() - vars->alts[vi].size();
+                    main_diag += vars->ref_lens[vi] - vars->alt_lens[vi];
 
                 // calculate max reaching path to right
                 int ref_len = score/extend + 3;
@@ -564,7 +567,7 @@ void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
                                 vars->clusters[clust], 
                                 vars->clusters[clust+1], 
                                 beg_pos, end_pos);
-                    ref = vcf->ref->fasta.at(ctg).substr(beg_pos, ref_len);
+                    ref = vcf->ref->seq(ctg).substr(beg_pos, ref_len);
                     // manage buffer for storing offsets
                     size_t offs_size = MATS * (std::max(sub, open+extend)+1) * 
                         (query.size() + ref.size() - 1);
@@ -583,7 +586,7 @@ void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
                 r_reach = beg_pos + reach + 1;
 
                 if (false) {
-                    printf("REF:        %s\n", ref.data());
+                    printf("REF:        %.*s\n", int(ref.size()), ref.data());
                     printf("QUERY:      %s\n", query.data());
                     printf(" main diag:  %d\n", main_diag);
                     printf("diag start:  %d\n\n", main_diag_start);
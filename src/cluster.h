@@ -52,10 +52,10 @@ public:
     void gap_supercluster();
 
     // data
-    std::vector<std::string> contigs;
+    std::vector<int> contigs;        // contig IDs
     std::vector<int> lengths;
     std::vector<int> ploidy;
-    std::unordered_map<std::string, 
+    std::vector< // indexed by contig ID
         std::shared_ptr<ctgSuperclusters> > ctg_superclusters;
     std::shared_ptr<fastaData> ref;
 };
@@ -63,7 +63,7 @@ public:
 
 // for single haplotype clustering (one VCF)
 void gap_cluster(std::shared_ptr<variantData> vcf, int callset);
-void wf_swg_cluster(variantData * vcf, std::string ctg, int hap,
+void wf_swg_cluster(variantData * vcf, int ctg, int hap,
         int sub, int open, int extend);
 std::vector< std::vector< std::vector<int> > > 
         sort_superclusters(std::shared_ptr<superclusterData>);
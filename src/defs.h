@@ -19,6 +19,11 @@ class idx2;
 #define CTG_IDX 0
 #define SC_IDX  1
 
+#define BATCH_HAP 0
+#define BATCH_CTG 1
+#define BATCH_BEG 2
+#define BATCH_END 3
+
 #define COLOR_BLUE "\033[34m"
 #define COLOR_WHITE "\033[0m"
 #define COLOR_PURPLE "\033[35m"
@@ -2,12 +2,15 @@
 #include <set>
 #include <vector>
 #include <cstdio>
+#include <cstring>
+#include <cstdint>
 #include <chrono>
 #include <utility>
 #include <queue>
 #include <thread>
 
 #include "dist.h"
+#include "simd.h"
 #include "edit.h"
 #include "print.h"
 #include "cluster.h"
@@ -65,7 +68,7 @@ void reverse_ptrs_strs(
 /* Generate the new sequence by applying variants to the reference. */
 std::string generate_str(
         std::shared_ptr<fastaData> ref, 
-        std::shared_ptr<ctgVariants> vars, const std::string & ctg,
+        std::shared_ptr<ctgVariants> vars, int ctg,
         int beg_idx, int end_idx, int beg_pos, int end_pos, 
         int min_qual /* = 0 */) {
 
@@ -79,18 +82,18 @@ std::string generate_str(
             if (vars->var_quals[var_idx] >= min_qual) {
                 switch (vars->types[var_idx]) {
                     case TYPE_INS:
-                        str += vars->alts[var_idx];
+                        str += vars->alt(var_idx);
                         break;
                     case TYPE_DEL:
-                        ref_pos += vars->refs[var_idx].size();
+                        ref_pos += vars->ref_lens[var_idx];
                         break;
                     case TYPE_SUB:
-                        str += vars->alts[var_idx];
+                        str += vars->alt(var_idx);
                         ref_pos++;
                         break;
                     case TYPE_CPX:
-                        str += vars->alts[var_idx];
-                        ref_pos += vars->refs[var_idx].size();
+                        str += vars->alt(var_idx);
+                        ref_pos += vars->ref_lens[var_idx];
                         break;
                 }
             }
@@ -105,15 +108,17 @@ std::string generate_str(
                     printf("ref_pos:%d ref_end:%d beg_pos: %d end_pos: %d\n",
                             ref_pos, ref_end, beg_pos, end_pos);
                     for(int i = beg_idx; i < end_idx; i++) {
-                        printf("%s:%d %s -> %s\n", ctg.data(), vars->poss[i], 
-                                vars->refs[i].data(), vars->alts[i].data());
+                        printf("%s:%d %s -> %s\n", ctg_dict.name(ctg).data(), vars->poss[i], 
+                                std::string(vars->ref(i)).data(), 
+                                std::string(vars->alt(i)).data());
                     }
                     ERROR("No variant, but ref_end < ref_pos (generate_str)");
                 }
-                str += ref->fasta.at(ctg).substr(ref_pos, ref_end-ref_pos);
+                str += ref->seq(ctg).substr(ref_pos, ref_end-ref_pos);
                 ref_pos = ref_end;
             } catch (const std::out_of_range & e) {
-                ERROR("Contig %s not in reference FASTA (generate_str)", ctg.data());
+                ERROR("Contig %s not in reference FASTA (generate_str)", 
+                        ctg_dict.name(ctg).data());
             }
         }
     }
@@ -134,7 +139,7 @@ void generate_ptrs_strs(
         std::shared_ptr<ctgVariants> query_vars,
         size_t query_clust_beg_idx, size_t query_clust_end_idx,
         int beg_pos, int end_pos, 
-        std::shared_ptr<fastaData> ref, const std::string & ctg
+        std::shared_ptr<fastaData> ref, int ctg
         ) {
 
     // generate query and ref strings and pointers
@@ -151,32 +156,32 @@ void generate_ptrs_strs(
             switch (query_vars->types[query_var_idx]) {
                 case TYPE_INS:
                     query_ptrs[PTRS].insert(query_ptrs[PTRS].end(), 
-                            query_vars->alts[query_var_idx].size(), ref_str.size()-1);
+                            query_vars->alt_lens[query_var_idx], ref_str.size()-1);
                     query_ptrs[FLAGS].insert(query_ptrs[FLAGS].end(),
-                            query_vars->alts[query_var_idx].size(), PTR_VARIANT);
+                            query_vars->alt_lens[query_var_idx], PTR_VARIANT);
                     query_ptrs[FLAGS][ query_ptrs[FLAGS].size()-1] |= PTR_VAR_END;
                     query_ptrs[FLAGS][ query_ptrs[FLAGS].size() - 
-                        query_vars->alts[query_var_idx].size()] |= PTR_VAR_BEG;
-                    query_str += query_vars->alts[query_var_idx];
+                        query_vars->alt_lens[query_var_idx]] |= PTR_VAR_BEG;
+                    query_str += query_vars->alt(query_var_idx);
                     break;
                 case TYPE_DEL:
                     ref_ptrs[PTRS].insert(ref_ptrs[PTRS].end(),
-                            query_vars->refs[query_var_idx].size(), query_str.size()-1);
+                            query_vars->ref_lens[query_var_idx], query_str.size()-1);
                     ref_ptrs[FLAGS].insert(ref_ptrs[FLAGS].end(),
-                            query_vars->refs[query_var_idx].size(), PTR_VARIANT);
+                            query_vars->ref_lens[query_var_idx], PTR_VARIANT);
                     ref_ptrs[FLAGS][ ref_ptrs[FLAGS].size()-1] |= PTR_VAR_END;
                     ref_ptrs[FLAGS][ ref_ptrs[FLAGS].size() - 
-                        query_vars->refs[query_var_idx].size()] |= PTR_VAR_BEG;
-                    ref_str += query_vars->refs[query_var_idx];
-                    ref_pos += query_vars->refs[query_var_idx].size();
+                        query_vars->ref_lens[query_var_idx]] |= PTR_VAR_BEG;
+                    ref_str += query_vars->ref(query_var_idx);
+                    ref_pos += query_vars->ref_lens[query_var_idx];
                     break;
                 case TYPE_SUB:
                     ref_ptrs[PTRS].push_back(query_str.size());
                     ref_ptrs[FLAGS].push_back(PTR_VARIANT|PTR_VAR_BEG|PTR_VAR_END);
                     query_ptrs[PTRS].push_back(ref_str.size());
                     query_ptrs[FLAGS].push_back(PTR_VARIANT|PTR_VAR_BEG|PTR_VAR_END);
-                    ref_str += query_vars->refs[query_var_idx];
-                    query_str += query_vars->alts[query_var_idx];
+                    ref_str += query_vars->ref(query_var_idx);
+                    query_str += query_vars->alt(query_var_idx);
                     ref_pos++;
                     break;
                 default:
@@ -211,19 +216,137 @@ void generate_ptrs_strs(
                         new_ref_ptrs.begin(), new_ref_ptrs.end());
 
                 // add sequence, update positions
-                std::string matches = ref->fasta.at(ctg).substr(ref_pos, ref_end-ref_pos);
+                std::string_view matches = ref->seq(ctg).substr(ref_pos, ref_end-ref_pos);
                 query_str += matches;
                 ref_str += matches;
                 ref_pos = ref_end;
 
             } catch (const std::out_of_range & e) {
-                ERROR("Contig '%s' not present in reference FASTA", ctg.data());
+                ERROR("Contig '%s' not present in reference FASTA", 
+                        ctg_dict.name(ctg).data());
             }
         }
     }
 }
 
 
+/******************************************************************************/
+
+/* Calculate the forward-pass edit distance for truth and query strings, 
+ * exactly as calc_prec_recall_aln() would, but without storing pointers. Cells
+ * are tracked in flat arrays rather than hash sets, so the four distances 
+ * needed to decide phasing are cheap; pointers are then only generated for the
+ * two alignments of the chosen phasing.
+ */
+void calc_prec_recall_score(
+        const std::string & query1, const std::string & query2,
+        const std::string & truth1, const std::string & truth2, 
+        const std::string & ref,
+        const std::vector< std::vector<int> > & query1_ref_ptrs, 
+        const std::vector< std::vector<int> > & ref_query1_ptrs,
+        const std::vector< std::vector<int> > & query2_ref_ptrs, 
+        const std::vector< std::vector<int> > & ref_query2_ptrs,
+        const std::vector< std::vector<int> > & truth1_ref_ptrs, 
+        const std::vector< std::vector<int> > & truth2_ref_ptrs,
+        std::vector<int> & s, int aln_start, int aln_stop
+        ) {
+
+    // set loop variables
+    int ref_len = ref.size();
+    const std::string * querys[] = {&query1, &query1, &query2, &query2};
+    const std::string * truths[] = {&truth1, &truth2, &truth1, &truth2};
+    const std::vector< std::vector<int> > * query_ref_ptrss[] = {
+            &query1_ref_ptrs, &query1_ref_ptrs, &query2_ref_ptrs, &query2_ref_ptrs };
+    const std::vector< std::vector<int> > * ref_query_ptrss[] = {
+            &ref_query1_ptrs, &ref_query1_ptrs, &ref_query2_ptrs, &ref_query2_ptrs };
+    const std::vector< std::vector<int> > * truth_ref_ptrss[] = {
+            &truth1_ref_ptrs, &truth2_ref_ptrs, &truth1_ref_ptrs, &truth2_ref_ptrs };
+
+    for (int i = aln_start; i < aln_stop; i++) {
+        const std::string & query = *querys[i];
+        const std::string & truth = *truths[i];
+        const std::vector< std::vector<int> > & query_ref_ptrs = *query_ref_ptrss[i];
+        const std::vector< std::vector<int> > & ref_query_ptrs = *ref_query_ptrss[i];
+        const std::vector< std::vector<int> > & truth_ref_ptrs = *truth_ref_ptrss[i];
+        int query_len = query.size();
+        int truth_len = truth.size();
+
+        // cell (hi, qri, ti) is at qri*truth_len + ti, REF cells after QUERY
+        auto cell = [&](const idx1 & x) { 
+            return (x.hi == REF ? query_len*truth_len : 0) + x.qri*truth_len + x.ti; };
+        std::vector<bool> done((query_len + ref_len) * truth_len, false);
+        std::vector<bool> in_wave((query_len + ref_len) * truth_len, false);
+        std::vector<idx1> queue, curr_wave, prev_wave;
+        auto visit = [&](const idx1 & y) {
+            if (done[cell(y)] || in_wave[cell(y)]) return;
+            queue.push_back(y);
+            curr_wave.push_back(y);
+            in_wave[cell(y)] = true;
+        };
+
+        // set first wavefront
+        s[i] = 0;
+        queue.push_back({QUERY, 0, 0});
+        queue.push_back({REF, 0, 0});
+        done[cell({QUERY, 0, 0})] = true;
+
+        while (true) {
+            if (queue.empty()) ERROR("Empty queue in 'prec_recall_score()'.");
+
+            // EXTEND WAVEFRONT (stay at same score)
+            for (size_t qi = 0; qi < queue.size(); qi++) {
+                idx1 x = queue[qi];
+                prev_wave.push_back(x);
+                const std::string & qr = x.hi == QUERY ? query : ref;
+                const std::string & swap_qr = x.hi == QUERY ? ref : query;
+                const std::vector< std::vector<int> > & swap_ptrs = 
+                        x.hi == QUERY ? query_ref_ptrs : ref_query_ptrs;
+
+                // allow match
+                if (x.qri+1 < int(qr.size()) && x.ti+1 < truth_len &&
+                        qr[x.qri+1] == truth[x.ti+1])
+                    visit(idx1(x.hi, x.qri+1, x.ti+1));
+
+                // allow match, swapping between query and reference
+                idx1 z(x.hi == QUERY ? REF : QUERY, swap_ptrs[PTRS][x.qri]+1, x.ti+1);
+                if ( (!(swap_ptrs[FLAGS][x.qri] & PTR_VARIANT) ||
+                        swap_ptrs[FLAGS][x.qri] & PTR_VAR_END) &&
+                     (!(truth_ref_ptrs[FLAGS][x.ti] & PTR_VARIANT) ||
+                        truth_ref_ptrs[FLAGS][x.ti] & PTR_VAR_END) &&
+                        z.qri < int(swap_qr.size()) && z.ti < truth_len &&
+                        swap_qr[z.qri] == truth[z.ti])
+                    visit(z);
+            }
+            queue.clear();
+
+            // mark all cells visited this wave as done
+            for (const idx1 & x : curr_wave) {
+                done[cell(x)] = true;
+                in_wave[cell(x)] = false;
+            }
+            curr_wave.clear();
+
+            // exit if we're done aligning
+            if (done[cell({QUERY, query_len-1, truth_len-1})] ||
+                done[cell({REF, ref_len-1, truth_len-1})]) break;
+
+            // NEXT WAVEFRONT (increase score by one)
+            for (const idx1 & x : prev_wave) {
+                int qr_len = (x.hi == QUERY) ? query_len : ref_len;
+                if (x.qri+1 < qr_len)                              // INS
+                    visit(idx1(x.hi, x.qri+1, x.ti));
+                if (x.ti+1 < truth_len)                            // DEL
+                    visit(idx1(x.hi, x.qri, x.ti+1));
+                if (x.qri+1 < qr_len && x.ti+1 < truth_len)        // SUB
+                    visit(idx1(x.hi, x.qri+1, x.ti+1));
+            }
+            prev_wave.clear();
+            s[i]++;
+        }
+    }
+}
+
+
 /******************************************************************************/
 
 /* Calculate initial forward-pass alignment for truth and query strings, given
@@ -430,7 +553,7 @@ void calc_prec_recall_aln(
 
 int store_phase( 
         superclusterData * clusterdata_ptr, 
-        const std::string & ctg, int sc_idx,
+        int ctg, int sc_idx,
         const std::vector<int> & s
         ) {
 
@@ -1061,8 +1184,7 @@ void get_prec_recall_path_sync(
 
 
 void calc_prec_recall(
-        superclusterData * clusterdata_ptr, int sc_idx, 
-        const std::string & ctg, 
+        superclusterData * clusterdata_ptr, int sc_idx, int ctg,
         const std::string & ref,
         const std::string & query1, const std::string & query2, 
         const std::string & truth1, const std::string & truth2, 
@@ -1090,6 +1212,8 @@ void calc_prec_recall(
     std::vector< std::vector< std::vector<int> > > truth_ref_ptrs = { 
             truth1_ref_ptrs, truth2_ref_ptrs, truth1_ref_ptrs, truth2_ref_ptrs };
 
+    std::vector<int> ed_offs; // wf_ed() scratch
+
     // indices into ptr/off matrices depend on decided phasing
     std::vector<int> indices;
     if (phase == PHASE_SWAP) {
@@ -1186,8 +1310,8 @@ void calc_prec_recall(
                     query_vars->callq[query_var_ptr] = 
                         query_vars->var_quals[query_var_ptr];
                     if (print) printf("QUERY REF='%s'\tALT='%s'\t%s\t%f\n",
-                            query_vars->refs[query_var_ptr].data(),
-                            query_vars->alts[query_var_ptr].data(), "FP", 0.0f);
+                            std::string(query_vars->ref(query_var_ptr)).data(),
+                            std::string(query_vars->alt(query_var_ptr)).data(), "FP", 0.0f);
                     query_var_ptr--;
                 } else { // TP/PP
                     query_var_ptr--;
@@ -1214,7 +1338,6 @@ void calc_prec_recall(
                 int old_ed = 0;
                 sync_ref_idx = (hi == ri) ? qri+1 : query_ref_ptrs[i][PTRS][qri]+1;
                 sync_truth_idx = ti+1;
-                std::vector< std::vector<int> > offs, ptrs;
                 if (print) {
                     printf("  ref: %2d %s\n", int(ref.size()), ref.data());
                     printf("truth: %2d %s\n", int(truth[i].size()), truth[i].data());
@@ -1225,11 +1348,10 @@ void calc_prec_recall(
                     printf("%s\n", truth[i].substr(sync_truth_idx, 
                                 prev_sync_truth_idx - sync_truth_idx).data());
                 }
-                wf_ed(ref.substr(sync_ref_idx, 
+                old_ed = wf_ed(std::string_view(ref).substr(sync_ref_idx, 
                             prev_sync_ref_idx - sync_ref_idx), 
-                        truth[i].substr(sync_truth_idx, 
-                            prev_sync_truth_idx - sync_truth_idx), 
-                        old_ed, offs, ptrs);
+                        std::string_view(truth[i]).substr(sync_truth_idx, 
+                            prev_sync_truth_idx - sync_truth_idx), ed_offs);
 
                 if (old_ed == 0 && truth_var_ptr != prev_truth_var_ptr) 
                     WARN("Old edit distance 0, TRUTH variants exist (%d-%d).", 
@@ -1253,24 +1375,24 @@ void calc_prec_recall(
                             query_vars->credit[query_var_idx] = credit;
                             query_vars->callq[query_var_idx] = callq;
                             if (print) printf("QUERY REF='%s'\tALT='%s'\t%s\t%f\n",
-                                    query_vars->refs[query_var_idx].data(),
-                                    query_vars->alts[query_var_idx].data(), 
+                                    std::string(query_vars->ref(query_var_idx)).data(),
+                                    std::string(query_vars->alt(query_var_idx)).data(), 
                                     "TP", credit);
                         } else if (new_ed == old_ed) { // FP
                             query_vars->errtypes[query_var_idx] = ERRTYPE_FP;
                             query_vars->credit[query_var_idx] = 0;
                             query_vars->callq[query_var_idx] = callq;
                             if (print) printf("QUERY REF='%s'\tALT='%s'\t%s\t%f\n",
-                                    query_vars->refs[query_var_idx].data(),
-                                    query_vars->alts[query_var_idx].data(), 
+                                    std::string(query_vars->ref(query_var_idx)).data(),
+                                    std::string(query_vars->alt(query_var_idx)).data(), 
                                     "FP", 0.0f);
                         } else { // PP
                             query_vars->errtypes[query_var_idx] = ERRTYPE_PP;
                             query_vars->credit[query_var_idx] = credit;
                             query_vars->callq[query_var_idx] = callq;
                             if (print) printf("QUERY REF='%s'\tALT='%s'\t%s\t%f\n",
-                                    query_vars->refs[query_var_idx].data(),
-                                    query_vars->alts[query_var_idx].data(), 
+                                    std::string(query_vars->ref(query_var_idx)).data(),
+                                    std::string(query_vars->alt(query_var_idx)).data(), 
                                     "PP", credit);
                         }
                     }
@@ -1285,24 +1407,24 @@ void calc_prec_recall(
                         truth_vars->credit[truth_var_idx] = credit;
                         truth_vars->callq[truth_var_idx] = callq;
                         if (print) printf("TRUTH REF='%s'\tALT='%s'\t%s\t%f\n",
-                                truth_vars->refs[truth_var_idx].data(),
-                                truth_vars->alts[truth_var_idx].data(), 
+                                std::string(truth_vars->ref(truth_var_idx)).data(),
+                                std::string(truth_vars->alt(truth_var_idx)).data(), 
                                 "TP", credit);
                     } else if (new_ed == old_ed) { // FP call, FN truth
                         truth_vars->errtypes[truth_var_idx] = ERRTYPE_FN;
                         truth_vars->credit[truth_var_idx] = credit;
                         truth_vars->callq[truth_var_idx] = g.max_qual;
                         if (print) printf("TRUTH REF='%s'\tALT='%s'\t%s\t%f\n",
-                                truth_vars->refs[truth_var_idx].data(),
-                                truth_vars->alts[truth_var_idx].data(), 
+                                std::string(truth_vars->ref(truth_var_idx)).data(),
+                                std::string(truth_vars->alt(truth_var_idx)).data(), 
                                 "FN", credit);
                     } else { // PP
                         truth_vars->errtypes[truth_var_idx] = ERRTYPE_PP;
                         truth_vars->credit[truth_var_idx] = credit;
                         truth_vars->callq[truth_var_idx] = callq;
                         if (print) printf("TRUTH REF='%s'\tALT='%s'\t%s\t%f\n",
-                                truth_vars->refs[truth_var_idx].data(),
-                                truth_vars->alts[truth_var_idx].data(), 
+                                std::string(truth_vars->ref(truth_var_idx)).data(),
+                                std::string(truth_vars->alt(truth_var_idx)).data(), 
                                 "PP", credit);
                     }
                 }
@@ -1353,10 +1475,13 @@ void calc_prec_recall(
 
 /******************************************************************************/
 
-void wf_ed(
-        const std::string & query, const std::string & truth, int & s, 
-        std::vector< std::vector<int> > & offs,
-        std::vector< std::vector<int> > & ptrs
+/* Unit-cost edit distance between `query` and `truth`. Only the score is
+ * needed, so just two rolling wavefronts are kept, in the caller's `offs`
+ * buffer (reused across calls, so it stops allocating once large enough).
+ */
+int wf_ed(
+        const seqView & query, const seqView & truth, 
+        std::vector<int> & offs
         ) {
 
     // alignment
@@ -1364,19 +1489,20 @@ void wf_ed(
     int truth_len = truth.size();
 
     // early exit if either string is empty
-    if (!query_len) { s = truth_len; return; }
-    if (!truth_len) { s = query_len; return; }
+    if (!query_len) return truth_len;
+    if (!truth_len) return query_len;
 
     int mat_len = query_len + truth_len - 1;
-    offs.push_back(std::vector<int>(mat_len, -2));
-    offs[0][query_len-1] = -1;
-    ptrs.push_back(std::vector<int>(mat_len, PTR_NONE));
-    bool done = false;
+    offs.assign(2*mat_len, -2);
+    int * curr = offs.data();
+    int * next = offs.data() + mat_len;
+    curr[query_len-1] = -1;
+    int s = 0;
     while (true) {
 
         // EXTEND WAVEFRONT
         for (int d = 0; d < mat_len; d++) {
-            int off = offs[s][d];
+            int off = curr[d];
             int diag = d + 1 - query_len;
 
             // don't allow starting from untouched cells
@@ -1388,210 +1514,313 @@ void wf_ed(
             if (diag + off > truth_len - 1) continue;
 
             // extend
-            while (off < query_len - 1 && 
-                   diag + off < truth_len - 1) {
-                if (query[off+1] == truth[diag+off+1]) off++;
-                else break;
-            }
-            offs[s][d] = off;
+            off += extend_match(query, off+1, truth, diag+off+1,
+                    std::min(query_len-1 - off, truth_len-1 - (diag+off)));
+            curr[d] = off;
 
             // finish if done
             if (off == query_len - 1 && off + diag == truth_len - 1)
-            { done = true; break; }
-
+                return s;
         }
-        if (done) break;
-
 
         // NEXT WAVEFRONT
-        // add wavefront, fill edge cells
-        offs.push_back(std::vector<int>(mat_len, -2));
-        ptrs.push_back(std::vector<int>(mat_len));
+        // fill edge cells (central cells are all overwritten)
+        next[0] = next[mat_len-1] = -2;
         // left cells
-        if (query_len > 1 && s+1 == query_len-1) {
-            offs[s+1][0] = s+1;
-            ptrs[s+1][0] = PTR_INS;
-        }
+        if (query_len > 1 && s+1 == query_len-1)
+            next[0] = s+1;
         // right cells
-        if (truth_len > 1 && s+1 == mat_len-1) {
-            offs[s+1][mat_len-1] = 0;
-            ptrs[s+1][mat_len-1] = PTR_DEL;
-        }
+        if (truth_len > 1 && s+1 == mat_len-1)
+            next[mat_len-1] = 0;
 
         // central cells
         for (int d = 1; d < mat_len-1; d++) {
-            int offleft = offs[s][d-1];
-            int offtop  = (offs[s][d+1] == -2) ? 
-                -2 : offs[s][d+1]+1;
-            int offdiag = (offs[s][d] == -2) ? 
-                -2 : offs[s][d]+1;
-            if (offdiag >= offtop && offdiag >= offleft) {
-                offs[s+1][d] = offdiag;
-                ptrs[s+1][d] = PTR_SUB;
-            } else if (offleft >= offtop) {
-                offs[s+1][d] = offleft;
-                ptrs[s+1][d] = PTR_DEL;
-            } else {
-                offs[s+1][d] = offtop;
-                ptrs[s+1][d] = PTR_INS;
-            }
+            int offleft = curr[d-1];
+            int offtop  = (curr[d+1] == -2) ? -2 : curr[d+1]+1;
+            int offdiag = (curr[d] == -2) ? -2 : curr[d]+1;
+            next[d] = std::max(offdiag, std::max(offleft, offtop));
         }
 
         // single cell
-        if (query_len == 1 && truth_len == 1) {
-            offs[s+1][0] = offs[s][0]+1;
-            ptrs[s+1][0] = PTR_SUB;
-        }
+        if (query_len == 1 && truth_len == 1)
+            next[0] = curr[0]+1;
+
+        std::swap(curr, next);
         ++s;
     }
 }
 
 /******************************************************************************/
 
-void wf_swg_align(
-        const std::string & query, const std::string & truth, 
-        std::vector< std::vector< std::vector<uint8_t> > > & ptrs,
-        std::vector< std::vector< std::vector<int> > > & offs,
-        int & s, int x, int o, int e, bool print
+/* Extend wavefront `s` along matches, returning true once the alignment is
+ * complete. */
+template <bool Print>
+bool wf_swg_extend(
+        const seqView & query, const seqView & truth, 
+        swgWavefronts & wf, int s
         ) {
+    int query_len = query.size();
+    int truth_len = truth.size();
+    int lo = wf.lo[s];
+    int hi = wf.hi[s];
+    std::vector<int> & sub_offs = wf.offs[MAT_SUB][s];
+    std::vector<uint8_t> & sub_ptrs = wf.ptrs[MAT_SUB][s];
+
+    // EXTEND WAVEFRONT (leave INS, DEL)
+    for (int m = MAT_INS; m < MATS; m++) {
+        for (int d = lo; d <= hi; d++) {
+            int off = wf.offs[m][s][d-lo];
+            int diag = d + 1 - query_len;
 
-    // init
+            if (off >= 0 && off < query_len &&
+                    diag+off >= 0 && diag+off < truth_len &&
+                    off >= sub_offs[d-lo]) {
+                sub_offs[d-lo] = off;
+                sub_ptrs[d-lo] |= (m == MAT_INS) ? PTR_INS : PTR_DEL;
+                if (Print) printf("(S, %d, %d) swap\n", sub_offs[d-lo], 
+                        sub_offs[d-lo]+d+1-query_len);
+
+            }
+        }
+    }
+
+    // EXTEND WAVEFRONT (diag, SUB only)
+    for (int d = lo; d <= hi; d++) {
+        int off = sub_offs[d-lo];
+        int diag = d + 1 - query_len;
+
+        // extend
+        int max_len = std::min(query_len-1 - off, truth_len-1 - (diag+off));
+        if (off != -2 && diag + off >= -1 && max_len > 0)
+            off += extend_match(query, off+1, truth, diag+off+1, max_len);
+        if (off > sub_offs[d-lo])
+            if (Print) printf("(S, %d, %d) extend\n", off, off+diag);
+        sub_offs[d-lo] = off;
+
+        // finish if done
+        if (off == query_len - 1 && off + diag == truth_len - 1)
+            return true;
+    }
+    return false;
+}
+
+/* Copy wavefront `s` of matrix `m` over diagonals [lo-1, hi+1] (unreached
+ * outside its band), returning a pointer to diagonal `lo`. */
+const int * wf_swg_row(const swgWavefronts & wf, int m, int s, 
+        int lo, int hi, std::vector<int> & row) {
+    row.assign(hi-lo+3, -2);
+    int beg = std::max(lo-1, wf.lo[s]);
+    int end = std::min(hi+1, wf.hi[s]);
+    if (beg <= end)
+        std::copy(wf.offs[m][s].begin() + (beg - wf.lo[s]),
+                wf.offs[m][s].begin() + (end - wf.lo[s] + 1), 
+                row.begin() + (beg - (lo-1)));
+    return row.data() + 1;
+}
+
+/* Compute (allocated) wavefront `s` from the previous wavefronts. */
+template <bool Print>
+void wf_swg_next(
+        const seqView & query, const seqView & truth, 
+        swgWavefronts & wf, int s, int x, int o, int e
+        ) {
     int query_len = query.size();
     int truth_len = truth.size();
     int mat_len = query_len + truth_len - 1;
-    bool done = false;
-    for (int m = 0; m < MATS; m++) {
-        offs[m].push_back(std::vector<int>(mat_len, -2));
-        ptrs[m].push_back(std::vector<uint8_t>(mat_len, PTR_NONE));
+    int lo = wf.lo[s];
+    int hi = wf.hi[s];
+
+    if (lo > hi) return;
+
+    // vectorized, over snapshots of the source rows padded to [lo-1, hi+1].
+    // A zero penalty makes a source row this wavefront itself, whose updates
+    // the scalar loop below chains through, so it cannot use snapshots.
+    bool simd = !Print && x > 0 && e > 0 && o+e > 0;
+    if (simd) {
+        wfStep step;
+        step.lo = lo; step.hi = hi;
+        step.query_len = query_len; step.truth_len = truth_len;
+        if (s-x >= 0)
+            step.sub_src = wf_swg_row(wf, MAT_SUB, s-x, lo, hi, wf.rows[0]);
+        if (s-(o+e) >= 0)
+            step.open_src = wf_swg_row(wf, MAT_SUB, s-(o+e), lo, hi, wf.rows[1]);
+        if (s-e >= 0) {
+            step.del_src = wf_swg_row(wf, MAT_DEL, s-e, lo, hi, wf.rows[2]);
+            step.ins_src = wf_swg_row(wf, MAT_INS, s-e, lo, hi, wf.rows[3]);
+        }
+        step.sub = wf.offs[MAT_SUB][s].data();
+        step.del = wf.offs[MAT_DEL][s].data();
+        step.ins = wf.offs[MAT_INS][s].data();
+        step.sub_ptrs = wf.ptrs[MAT_SUB][s].data();
+        step.del_ptrs = wf.ptrs[MAT_DEL][s].data();
+        step.ins_ptrs = wf.ptrs[MAT_INS][s].data();
+        wf_step(step);
+        return;
     }
-    s = 0;
-    offs[MAT_SUB][s][query_len-1] = -1; // main diag
-    ptrs[MAT_SUB][s][query_len-1] = PTR_MAT;
 
-    while (true) {
+    for (int d = lo; d <= hi; d++) {
+        int diag = d + 1 - query_len;
+        int & sub_off = wf.offs[MAT_SUB][s][d-lo];
+        int & del_off = wf.offs[MAT_DEL][s][d-lo];
+        int & ins_off = wf.offs[MAT_INS][s][d-lo];
+
+        // sub (in SUB)
+        int prev_off = s-x >= 0 ? wf.off(MAT_SUB, s-x, d) : -2;
+        if (prev_off != -2 && prev_off+1 < query_len &&
+                 diag + prev_off+1 < truth_len && prev_off+1 >= sub_off) {
+            sub_off = prev_off + 1;
+            wf.ptrs[MAT_SUB][s][d-lo] |= PTR_SUB;
+            if (Print) printf("(S, %d, %d) sub\n", sub_off, sub_off+diag);
+        }
 
-        // EXTEND WAVEFRONT (leave INS, DEL)
-        for (int m = MAT_INS; m < MATS; m++) {
-            for (int d = 0; d < mat_len; d++) {
-                int off = offs[m][s][d];
-                int diag = d + 1 - query_len;
+        // open gap (enter DEL)
+        prev_off = s-(o+e) >= 0 && d > 0 ? wf.off(MAT_SUB, s-(o+e), d-1) : -2;
+        if (prev_off != -2 && diag + prev_off < truth_len && prev_off >= del_off) {
+            del_off = prev_off;
+            wf.ptrs[MAT_DEL][s][d-lo] |= PTR_SUB;
+            if (Print) printf("(D, %d, %d) open\n", del_off, del_off+diag);
+        }
 
-                if (off >= 0 && off < query_len &&
-                        diag+off >= 0 && diag+off < truth_len &&
-                        offs[m][s][d] >= offs[MAT_SUB][s][d]) {
-                    offs[MAT_SUB][s][d] = offs[m][s][d];
-                    ptrs[MAT_SUB][s][d] |= (m == MAT_INS) ? PTR_INS : PTR_DEL;
-                    if(print) printf("(S, %d, %d) swap\n", offs[MAT_SUB][s][d], 
-                            offs[MAT_SUB][s][d]+d+1-query_len);
+        // open gap (enter INS)
+        prev_off = s-(o+e) >= 0 && d < mat_len-1 ? 
+            wf.off(MAT_SUB, s-(o+e), d+1) : -2;
+        if (prev_off != -2 && prev_off+1 < query_len &&
+                diag + prev_off+1 < truth_len && diag + prev_off+1 >= 0 &&
+                prev_off+1 >= ins_off) {
+            ins_off = prev_off+1;
+            wf.ptrs[MAT_INS][s][d-lo] |= PTR_SUB;
+            if (Print) printf("(I, %d, %d) open\n", ins_off, ins_off+diag);
+        }
 
-                }
-            }
+        // extend gap (stay DEL)
+        prev_off = s-e >= 0 && d > 0 ? wf.off(MAT_DEL, s-e, d-1) : -2;
+        if (prev_off != -2 && diag + prev_off < truth_len && prev_off >= del_off) {
+            del_off = prev_off;
+            wf.ptrs[MAT_DEL][s][d-lo] |= PTR_DEL;
+            if (Print) printf("(D, %d, %d) extend\n", del_off, del_off+diag);
         }
 
-        // EXTEND WAVEFRONT (diag, SUB only)
-        for (int d = 0; d < mat_len; d++) {
-            int off = offs[MAT_SUB][s][d];
-            int diag = d + 1 - query_len;
+        // extend gap (stay INS)
+        prev_off = s-e >= 0 && d < mat_len-1 ? wf.off(MAT_INS, s-e, d+1) : -2;
+        if (prev_off != -2 && prev_off+1 < query_len &&
+                diag + prev_off+1 < truth_len && diag + prev_off+1 >= 0 &&
+                prev_off+1 >= ins_off) {
+            ins_off = prev_off+1;
+            wf.ptrs[MAT_INS][s][d-lo] |= PTR_INS;
+            if (Print) printf("(I, %d, %d) extend\n", ins_off, ins_off+diag);
+        }
+    }
+}
 
-            // extend
-            while ( off != -2 && diag + off >= -1 && 
-                    off < query_len - 1 && 
-                    diag + off < truth_len - 1) {
-                if (query[off+1] == truth[diag+off+1]) off++;
-                else break;
-            }
-            if (off > offs[MAT_SUB][s][d])
-                if(print) printf("(S, %d, %d) extend\n", off, off+diag);
-            offs[MAT_SUB][s][d] = off;
+/* Recompute released wavefront `s` from the checkpoint before it, first
+ * releasing all later wavefronts, which backtracking has already passed. */
+void wf_swg_restore(
+        const seqView & query, const seqView & truth, 
+        swgWavefronts & wf, int s, int x, int o, int e
+        ) {
+    if (s < 0 || !wf.released[s]) return;
+    for (int t = s+1; t < int(wf.lo.size()); t++)
+        wf.release(t);
+    for (int t = s - s % wf.interval; t <= s; t++) {
+        if (!wf.released[t]) continue;
+        wf.alloc(t);
+        wf_swg_next<false>(query, truth, wf, t, x, o, e);
+        wf_swg_extend<false>(query, truth, wf, t);
+    }
+}
 
-            // finish if done
-            if (off == query_len - 1 && off + diag == truth_len - 1)
-            { done = true; break; }
-        }
-        if (done) break;
+/******************************************************************************/
+
+/* Penalties X/O/E are fixed at compile time if nonzero (see wf_swg_align()). */
+template <bool Print, int X, int O, int E>
+void wf_swg_align_impl(
+        const seqView & query, const seqView & truth, 
+        swgWavefronts & wf,
+        int & s, int x, int o, int e
+        ) {
+    if (X) { x = X; o = O; e = E; }
+
+    // init
+    int query_len = query.size();
+    int truth_len = truth.size();
+    int mat_len = query_len + truth_len - 1;
+    s = 0;
+    wf.add(query_len-1, query_len-1);
+    wf.offs[MAT_SUB][s][0] = -1; // main diag
+    wf.ptrs[MAT_SUB][s][0] = PTR_MAT;
+
+    // zero penalties chain within a wavefront, so its band is unbounded
+    bool full_band = x == 0 || e == 0 || o+e == 0;
+    wf.window = std::max(x, o+e);
+
+    while (true) {
+
+        if (wf_swg_extend<Print>(query, truth, wf, s)) break;
 
         for (int mi = 0; mi < MATS; mi++) {
-            if(print) printf("\n%s matrix\n", type_strs[mi+1].data());
-            if(print) printf("offs %d:", s);
+            if (Print) printf("\n%s matrix\n", type_strs[mi+1].data());
+            if (Print) printf("offs %d:", s);
             for (int di = 0; di < int(query.size() + truth.size()-1); di++) {
-                if(print) printf("\t%d", offs[mi][s][di]);
+                if (Print) printf("\t%d", wf.off(mi, s, di));
             }
-            if(print) printf("\n");
+            if (Print) printf("\n");
         }
 
         // NEXT WAVEFRONT
         s++;
-        if(print) printf("\nscore = %d\n", s);
-        for (int m = 0; m < MATS; m++) {
-            offs[m].push_back(std::vector<int>(mat_len, -2));
-            ptrs[m].push_back(std::vector<uint8_t>(mat_len, PTR_NONE));
-        }
-
-        for (int d = 0; d < mat_len; d++) {
-            int diag = d + 1 - query_len;
+        if (Print) printf("\nscore = %d\n", s);
 
-            // sub (in SUB)
-            if (s-x >= 0 && offs[MAT_SUB][s-x][d] != -2 && 
-                            offs[MAT_SUB][s-x][d]+1 < query_len &&
-                     diag + offs[MAT_SUB][s-x][d]+1 < truth_len &&
-                            offs[MAT_SUB][s-x][d]+1 >= offs[MAT_SUB][s][d]) {
-                offs[MAT_SUB][s][d] = offs[MAT_SUB][s-x][d] + 1;
-                ptrs[MAT_SUB][s][d] |= PTR_SUB;
-                if(print) printf("(S, %d, %d) sub\n", offs[MAT_SUB][s][d], 
-                        offs[MAT_SUB][s][d]+diag);
+        // diagonals reachable from previous wavefronts
+        int lo = mat_len, hi = -1;
+        if (full_band) {
+            lo = 0; hi = mat_len-1;
+        } else {
+            if (s-x >= 0) {
+                lo = std::min(lo, wf.lo[s-x]);
+                hi = std::max(hi, wf.hi[s-x]);
             }
-
-            // open gap (enter DEL)
-            if (s-(o+e) >= 0 && d > 0 && 
-                           offs[MAT_SUB][s-(o+e)][d-1] != -2 &&
-                    diag + offs[MAT_SUB][s-(o+e)][d-1] < truth_len &&
-                           offs[MAT_SUB][s-(o+e)][d-1] >= offs[MAT_DEL][s][d]) {
-                offs[MAT_DEL][s][d] = offs[MAT_SUB][s-(o+e)][d-1];
-                ptrs[MAT_DEL][s][d] |= PTR_SUB;
-                if(print) printf("(D, %d, %d) open\n", offs[MAT_DEL][s][d], 
-                        offs[MAT_DEL][s][d]+diag);
+            if (s-(o+e) >= 0) {
+                lo = std::min(lo, wf.lo[s-(o+e)]-1);
+                hi = std::max(hi, wf.hi[s-(o+e)]+1);
             }
-
-            // open gap (enter INS)
-            if (s-(o+e) >= 0 && d < mat_len-1 && 
-                           offs[MAT_SUB][s-(o+e)][d+1] != -2 &&
-                           offs[MAT_SUB][s-(o+e)][d+1]+1 < query_len &&
-                    diag + offs[MAT_SUB][s-(o+e)][d+1]+1 < truth_len &&
-                    diag + offs[MAT_SUB][s-(o+e)][d+1]+1 >= 0 &&
-                           offs[MAT_SUB][s-(o+e)][d+1]+1 >= offs[MAT_INS][s][d]) {
-                offs[MAT_INS][s][d] = offs[MAT_SUB][s-(o+e)][d+1]+1;
-                ptrs[MAT_INS][s][d] |= PTR_SUB;
-                if(print) printf("(I, %d, %d) open\n", offs[MAT_INS][s][d], 
-                        offs[MAT_INS][s][d]+diag);
-            }
-
-            // extend gap (stay DEL)
-            if (s-e >= 0 && d > 0 && 
-                           offs[MAT_DEL][s-e][d-1] != -2 &&
-                    diag + offs[MAT_DEL][s-e][d-1] < truth_len &&
-                           offs[MAT_DEL][s-e][d-1] >= offs[MAT_DEL][s][d]) {
-                offs[MAT_DEL][s][d] = offs[MAT_DEL][s-e][d-1];
-                ptrs[MAT_DEL][s][d] |= PTR_DEL;
-                if(print) printf("(D, %d, %d) extend\n", offs[MAT_DEL][s][d], 
-                        offs[MAT_DEL][s][d]+diag);
-            }
-
-            // extend gap (stay INS)
-            if (s-e >= 0 && d < mat_len-1 && 
-                           offs[MAT_INS][s-e][d+1] != -2 &&
-                           offs[MAT_INS][s-e][d+1]+1 < query_len &&
-                    diag + offs[MAT_INS][s-e][d+1]+1 < truth_len &&
-                    diag + offs[MAT_INS][s-e][d+1]+1 >= 0 &&
-                           offs[MAT_INS][s-e][d+1]+1 >= offs[MAT_INS][s][d]) {
-                offs[MAT_INS][s][d] = offs[MAT_INS][s-e][d+1]+1;
-                ptrs[MAT_INS][s][d] |= PTR_INS;
-                if(print) printf("(I, %d, %d) extend\n", offs[MAT_INS][s][d], 
-                        offs[MAT_INS][s][d]+diag);
+            if (s-e >= 0) {
+                lo = std::min(lo, wf.lo[s-e]-1);
+                hi = std::max(hi, wf.hi[s-e]+1);
             }
+            lo = std::max(lo, 0);
+            hi = std::min(hi, mat_len-1);
+        }
+        wf.add(lo, hi);
+        wf_swg_next<Print>(query, truth, wf, s, x, o, e);
+
+        // bound memory: keep only checkpoints and the current window
+        if (!full_band && !wf.interval && wf.cells > wf.max_cells) {
+            wf.interval = wf.checkpoints * wf.window;
+            for (int t = 0; t < s - wf.window; t++)
+                if (!wf.checkpoint(t)) wf.release(t);
         }
+        if (wf.interval && s - wf.window >= 0 && !wf.checkpoint(s - wf.window))
+            wf.release(s - wf.window);
     }
 }
 
+/* Specialized for the default realignment (5/6/2) and evaluation (3/2/1)
+ * penalties, so their strides are constants and debug printing compiles out. */
+void wf_swg_align(
+        const seqView & query, const seqView & truth, 
+        swgWavefronts & wf,
+        int & s, int x, int o, int e, bool print
+        ) {
+    if (print)
+        wf_swg_align_impl<true, 0, 0, 0>(query, truth, wf, s, x, o, e);
+    else if (x == 5 && o == 6 && e == 2)
+        wf_swg_align_impl<false, 5, 6, 2>(query, truth, wf, s, x, o, e);
+    else if (x == 3 && o == 2 && e == 1)
+        wf_swg_align_impl<false, 3, 2, 1>(query, truth, wf, s, x, o, e);
+    else
+        wf_swg_align_impl<false, 0, 0, 0>(query, truth, wf, s, x, o, e);
+}
+
 /******************************************************************************/
 
 void precision_recall_threads_wrapper(
@@ -1676,7 +1905,7 @@ void precision_recall_wrapper(
     if (stop == start) return;
 
     for (int idx = start; idx < stop; idx++) {
-        std::string ctg = clusterdata_ptr->contigs[
+        int ctg = clusterdata_ptr->contigs[
             sc_groups[thread_step][CTG_IDX][idx]];
         int sc_idx = sc_groups[thread_step][SC_IDX][idx];
 
@@ -1707,9 +1936,9 @@ void precision_recall_wrapper(
                     printf("\tCluster %d: %d variants (%d-%d)\n", j, 
                         variant_end-variant_beg, variant_beg, variant_end);
                     for (int k = variant_beg; k < variant_end; k++) {
-                        printf("\t\t%s %d\t%s\t%s\tQ=%f\n", ctg.data(), vars->poss[k], 
-                        vars->refs[k].size() ?  vars->refs[k].data() : "_", 
-                        vars->alts[k].size() ?  vars->alts[k].data() : "_",
+                        printf("\t\t%s %d\t%s\t%s\tQ=%f\n", ctg_dict.name(ctg).data(), vars->poss[k], 
+                        vars->ref_lens[k] ? std::string(vars->ref(k)).data() : "_", 
+                        vars->alt_lens[k] ? std::string(vars->alt(k)).data() : "_",
                         vars->var_quals[k]);
                     }
                 }
@@ -1764,59 +1993,86 @@ void precision_recall_wrapper(
         // calculate four forward-pass alignment edit dists
         // query1-truth2, query1-truth1, query2-truth1, query2-truth2
         std::vector<int> aln_score(HAPS*CALLSETS);
-        std::vector<int> aln_query_ref_end(HAPS*CALLSETS);
-        std::vector< std::vector< std::vector<uint8_t> > > aln_ptrs;
-        aln_ptrs.push_back(std::vector< std::vector<uint8_t> >(query1.size(), // Q1T1
-                    std::vector<uint8_t>(truth1.size(), PTR_NONE)));
-        aln_ptrs.push_back(std::vector< std::vector<uint8_t> >(ref_q1.size(),
-                    std::vector<uint8_t>(truth1.size(), PTR_NONE)));
-        aln_ptrs.push_back(std::vector< std::vector<uint8_t> >(query1.size(), // Q1T2
-                    std::vector<uint8_t>(truth2.size(), PTR_NONE)));
-        aln_ptrs.push_back(std::vector< std::vector<uint8_t> >(ref_q1.size(),
-                    std::vector<uint8_t>(truth2.size(), PTR_NONE)));
-        aln_ptrs.push_back(std::vector< std::vector<uint8_t> >(query2.size(), // Q2T1
-                    std::vector<uint8_t>(truth1.size(), PTR_NONE)));
-        aln_ptrs.push_back(std::vector< std::vector<uint8_t> >(ref_q2.size(),
-                    std::vector<uint8_t>(truth1.size(), PTR_NONE)));
-        aln_ptrs.push_back(std::vector< std::vector<uint8_t> >(query2.size(), // Q2T2
-                    std::vector<uint8_t>(truth2.size(), PTR_NONE)));
-        aln_ptrs.push_back(std::vector< std::vector<uint8_t> >(ref_q2.size(),
-                    std::vector<uint8_t>(truth2.size(), PTR_NONE)));
-        std::vector< std::shared_ptr< std::unordered_map<idx1, idx1> > > swap_pred_maps; 
-        for (int i = 0; i < CALLSETS*HAPS; i++)
-            swap_pred_maps.push_back(std::shared_ptr< std::unordered_map<idx1, idx1> >(new std::unordered_map<idx1, idx1>()));
 
         // if memory-limited and each subproblem is large, 
         // spawn a new thread for each of the 4 alignments
         if (thread4) {
             std::vector<std::thread> threads;
             for (int ti = 0; ti < CALLSETS*HAPS; ti++) {
-                threads.push_back(std::thread( calc_prec_recall_aln,
+                threads.push_back(std::thread( calc_prec_recall_score,
                     std::cref(query1), std::cref(query2), 
                     std::cref(truth1), std::cref(truth2), std::cref(ref_q1),
                     std::cref(query1_ref_ptrs), std::cref(ref_query1_ptrs), 
                     std::cref(query2_ref_ptrs), std::cref(ref_query2_ptrs),
                     std::cref(truth1_ref_ptrs), std::cref(truth2_ref_ptrs),
-                    std::ref(aln_score), std::ref(aln_ptrs), 
-                    std::ref(swap_pred_maps), std::ref(aln_query_ref_end), 
-                    ti, ti+1, false));
+                    std::ref(aln_score), ti, ti+1));
             }
             for (auto & t : threads)
                 t.join();
         } else { // calculate 4 alignments in this thread
-            calc_prec_recall_aln(
+            calc_prec_recall_score(
                     query1, query2, truth1, truth2, ref_q1,
                     query1_ref_ptrs, ref_query1_ptrs, 
                     query2_ref_ptrs, ref_query2_ptrs,
                     truth1_ref_ptrs, truth2_ref_ptrs,
-                    aln_score, aln_ptrs, swap_pred_maps,
-                    aln_query_ref_end, 0, CALLSETS*HAPS, false);
+                    aln_score, 0, CALLSETS*HAPS);
         }
 
         // store optimal phasing for each supercluster
         // ORIG: query1-truth1 and query2-truth2
         // SWAP: query1-truth2 and query2-truth1
         int phase = store_phase(clusterdata_ptr, ctg, sc_idx, aln_score);
+        std::vector<int> alns = phase == PHASE_SWAP ? 
+            std::vector<int>{QUERY1_TRUTH2, QUERY2_TRUTH1} : 
+            std::vector<int>{QUERY1_TRUTH1, QUERY2_TRUTH2};
+
+        // forward-pass alignment pointers, only for the chosen phasing
+        std::vector<int> aln_ptr_score(HAPS*CALLSETS);
+        std::vector<int> aln_query_ref_end(HAPS*CALLSETS);
+        std::vector< std::vector< std::vector<uint8_t> > > aln_ptrs(HAPS*CALLSETS*2);
+        std::vector< std::shared_ptr< std::unordered_map<idx1, idx1> > > swap_pred_maps; 
+        for (int i = 0; i < CALLSETS*HAPS; i++)
+            swap_pred_maps.push_back(std::shared_ptr< std::unordered_map<idx1, idx1> >(new std::unordered_map<idx1, idx1>()));
+        for (int i : alns) {
+            const std::string & query = i < QUERY2_TRUTH1 ? query1 : query2;
+            const std::string & ref_q = i < QUERY2_TRUTH1 ? ref_q1 : ref_q2;
+            const std::string & truth = i % 2 ? truth2 : truth1;
+            aln_ptrs[2*i + QUERY].assign(query.size(), 
+                    std::vector<uint8_t>(truth.size(), PTR_NONE));
+            aln_ptrs[2*i + REF].assign(ref_q.size(), 
+                    std::vector<uint8_t>(truth.size(), PTR_NONE));
+        }
+        if (thread4) {
+            std::vector<std::thread> threads;
+            for (int ti : alns) {
+                threads.push_back(std::thread( calc_prec_recall_aln,
+                    std::cref(query1), std::cref(query2), 
+                    std::cref(truth1), std::cref(truth2), std::cref(ref_q1),
+                    std::cref(query1_ref_ptrs), std::cref(ref_query1_ptrs), 
+                    std::cref(query2_ref_ptrs), std::cref(ref_query2_ptrs),
+                    std::cref(truth1_ref_ptrs), std::cref(truth2_ref_ptrs),
+                    std::ref(aln_ptr_score), std::ref(aln_ptrs), 
+                    std::ref(swap_pred_maps), std::ref(aln_query_ref_end), 
+                    ti, ti+1, false));
+            }
+            for (auto & t : threads)
+                t.join();
+        } else {
+            for (int ti : alns) {
+                calc_prec_recall_aln(
+                        query1, query2, truth1, truth2, ref_q1,
+                        query1_ref_ptrs, ref_query1_ptrs, 
+                        query2_ref_ptrs, ref_query2_ptrs,
+                        truth1_ref_ptrs, truth2_ref_ptrs,
+                        aln_ptr_score, aln_ptrs, swap_pred_maps,
+                        aln_query_ref_end, ti, ti+1, false);
+            }
+        }
+        for (int i : alns) {
+            if (aln_ptr_score[i] != aln_score[i])
+                ERROR("Alignment %s score %d differs from score-only %d",
+                        aln_strs[i].data(), aln_ptr_score[i], aln_score[i]);
+        }
 
         // calculate paths from alignment
         std::vector< std::vector<idx1> > path(HAPS);
@@ -1854,7 +2110,7 @@ editData edits_wrapper(std::shared_ptr<superclusterData> clusterdata_ptr) {
     // which doesn't contain any variants (to get draft reference edit dist)
     std::vector<int> all_qual_dists(g.max_qual+2, 0);
     editData edits;
-    for (std::string ctg : clusterdata_ptr->contigs) {
+    for (int ctg : clusterdata_ptr->contigs) {
         std::vector<int> ctg_qual_dists(g.max_qual+2,0);
 
         // set superclusters pointer
@@ -1886,9 +2142,9 @@ editData edits_wrapper(std::shared_ptr<superclusterData> clusterdata_ptr) {
                         printf("\tCluster %d: %d variants (%d-%d)\n", j, 
                             variant_end-variant_beg, variant_beg, variant_end);
                         for (int k = variant_beg; k < variant_end; k++) {
-                            printf("\t\t%s %d\t%s\t%s\tQ=%f\n", ctg.data(), vars->poss[k], 
-                            vars->refs[k].size() ?  vars->refs[k].data() : "_", 
-                            vars->alts[k].size() ?  vars->alts[k].data() : "_",
+                            printf("\t\t%s %d\t%s\t%s\tQ=%f\n", ctg_dict.name(ctg).data(), vars->poss[k], 
+                            vars->ref_lens[k] ? std::string(vars->ref(k)).data() : "_", 
+                            vars->alt_lens[k] ? std::string(vars->alt(k)).data() : "_",
                             vars->var_quals[k]);
                         }
                     }
@@ -1926,10 +2182,10 @@ editData edits_wrapper(std::shared_ptr<superclusterData> clusterdata_ptr) {
             /////////////////////////////////////////////////////////////////////
             
             // keep or swap truth haps based on previously decided phasing
-            std::vector<std::string> truth(2);
+            std::vector<std::string_view> truth(2);
             if (phase < 0) {
                 ERROR("Phase never set for supercluster %d on contig '%s'",
-                        sc_idx, ctg.data());
+                        sc_idx, ctg_dict.name(ctg).data());
             } else if (phase == PHASE_SWAP) {
                 truth[HAP1] = truth2; truth[HAP2] = truth1;
             } else {
@@ -1970,17 +2226,13 @@ editData edits_wrapper(std::shared_ptr<superclusterData> clusterdata_ptr) {
                             prev_qual);
 
                     // align strings, backtrack, calculate distance
-                    std::vector< std::vector< std::vector<uint8_t> > > ptrs(MATS);
-                    std::vector< std::vector< std::vector<int> > > offs(MATS);
+                    swgWavefronts wf;
                     int s = 0;
-                    std::reverse(query.begin(), query.end());
-                    std::reverse(truth[hap].begin(), truth[hap].end());
-                    wf_swg_align(query, truth[hap], ptrs, offs,
+                    seqView query_rev(query, true), truth_rev(truth[hap], true);
+                    wf_swg_align(query_rev, truth_rev, wf,
                             s, g.eval_sub, g.eval_open, g.eval_extend, false);
-                    std::vector<int> cigar = wf_swg_backtrack(query, truth[hap], 
-                            ptrs, offs, s, g.eval_sub, g.eval_open, g.eval_extend, false);
-                    std::reverse(query.begin(), query.end());
-                    std::reverse(truth[hap].begin(), truth[hap].end());
+                    std::vector<int> cigar = wf_swg_backtrack(query_rev, truth_rev, 
+                            wf, s, g.eval_sub, g.eval_open, g.eval_extend, false);
                     std::reverse(cigar.begin(), cigar.end());
                     int dist = count_dist(cigar);
 
@@ -2020,11 +2272,11 @@ int calc_vcf_swg_score(std::shared_ptr<ctgVariants> vars,
                 break;
             case TYPE_INS:
                 score += open;
-                score += extend * vars->alts[var_idx].size();
+                score += extend * vars->alt_lens[var_idx];
                 break;
             case TYPE_DEL:
                 score += open;
-                score += extend * vars->refs[var_idx].size();
+                score += extend * vars->ref_lens[var_idx];
                 break;
             default:
                 ERROR("Unexpected variant type in calc_vcf_swg_score()");
@@ -2067,12 +2319,14 @@ int calc_cig_swg_score(const std::vector<int> & cigar,
 
 /******************************************************************************/
 
-int wf_swg_max_reach(
-        const std::string & query, const std::string & truth, 
+template <bool Print, int X, int O, int E>
+int wf_swg_max_reach_impl(
+        const seqView & query, const seqView & truth, 
         std::vector<int> & offs,
         int main_diag, int main_diag_start, int max_score, 
-        int x, int o, int e, bool print /* false */, bool reverse /* false */
+        int x, int o, int e, bool reverse
         ) {
+    if (X) { x = X; o = O; e = E; }
 
     // init
     int query_len = query.size();
@@ -2086,6 +2340,9 @@ int wf_swg_max_reach(
     int z = y * scores;
     offs[MAT_SUB*z + s2*y + query_len-1] = -1;
 
+    // vector kernel requires all source rows distinct from the new row
+    bool simd = !Print && x > 0 && e > 0 && o > 0;
+
     while (true) {
 
         // EXTEND WAVEFRONT (leave INS, DEL forwards)
@@ -2098,7 +2355,7 @@ int wf_swg_max_reach(
                         diag+off >= 0 && diag+off < truth_len &&
                         off >= offs[MAT_SUB*z + s2*y + d]) {
                     offs[MAT_SUB*z + s2*y + d] = off;
-                    if(print) printf("(S, %d, %d) swap fwd\n", off, off+diag);
+                    if (Print) printf("(S, %d, %d) swap fwd\n", off, off+diag);
 
                 }
             }
@@ -2109,16 +2366,13 @@ int wf_swg_max_reach(
             int off = offs[MAT_SUB*z + s2*y + d];
             int diag = d + 1 - query_len;
 
-            // extend
-            while ( (diag != main_diag || off+1 < main_diag_off) &&
-                        off != -2 && diag + off >= -1 && 
-                        off < query_len - 1 && 
-                        diag + off < truth_len - 1) {
-                if (query[off+1] == truth[diag+off+1]) off++;
-                else break;
-            }
+            // extend (main diagonal stops before its starting offset)
+            int max_len = std::min(query_len-1 - off, truth_len-1 - (diag+off));
+            if (diag == main_diag) max_len = std::min(max_len, main_diag_off-1 - off);
+            if (off != -2 && diag + off >= -1 && max_len > 0)
+                off += extend_match(query, off+1, truth, diag+off+1, max_len);
             if (off > offs[MAT_SUB*z + s2*y + d])
-                if(print) printf("(S, %d, %d) extend\n", off, off+diag);
+                if (Print) printf("(S, %d, %d) extend\n", off, off+diag);
             offs[MAT_SUB*z + s2*y + d] = off;
 
             // finish if we've reached the last column
@@ -2133,7 +2387,7 @@ int wf_swg_max_reach(
         }
         if (s == max_score) break;
 
-        /* if (print) for (int mi = 0; mi < MATS; mi++) { */
+        /* if (Print) for (int mi = 0; mi < MATS; mi++) { */
         /*     printf("\n%s matrix\n", type_strs[mi+1].data()); */
         /*     printf("offs %d:", s); */
         /*     for (int di = 0; di < int(query.size() + truth.size()-1); di++) { */
@@ -2151,7 +2405,42 @@ int wf_swg_max_reach(
                 offs[m*z + s2*y + d] = -2;
             }
         }
-        if (print) printf("\nscore = %d\n", s);
+        if (Print) printf("\nscore = %d\n", s);
+
+        if (simd) {
+            wfStep step;
+            step.lo = 0; step.hi = mat_len-1;
+            step.query_len = query_len; step.truth_len = truth_len;
+            int open = reverse ? e : o+e;
+            if (s-x >= 0) step.sub_src = 
+                &offs[MAT_SUB*z + (s2-x + (s2 < x ? scores : 0))*y];
+            if (s-open >= 0) step.open_src = 
+                &offs[MAT_SUB*z + (s2-open + (s2 < open ? scores : 0))*y];
+            if (s-e >= 0) {
+                step.del_src = &offs[MAT_DEL*z + (s2-e + (s2 < e ? scores : 0))*y];
+                step.ins_src = &offs[MAT_INS*z + (s2-e + (s2 < e ? scores : 0))*y];
+            }
+            step.sub = &offs[MAT_SUB*z + s2*y];
+            step.del = &offs[MAT_DEL*z + s2*y];
+            step.ins = &offs[MAT_INS*z + s2*y];
+            wf_step(step);
+
+            // leave INDEL (open rev only)
+            int p2 = s2 - o;
+            if (p2 < 0) p2 += scores;
+            if (reverse && s-o >= 0) for (int d = 0; d < mat_len; d++) {
+                int diag = d + 1 - query_len;
+                for (int m = MAT_INS; m < MATS; m++) {
+                    if (        offs[m*z + p2*y + d] >= 0 && 
+                                offs[m*z + p2*y + d] < query_len &&
+                         diag + offs[m*z + p2*y + d] >= 0 && 
+                         diag + offs[m*z + p2*y + d] < truth_len &&
+                                offs[m*z + p2*y + d] > offs[MAT_SUB*z + s2*y + d])
+                        offs[MAT_SUB*z + s2*y + d] = offs[m*z + p2*y + d];
+                }
+            }
+            continue;
+        }
 
         for (int d = 0; d < mat_len; d++) {
             int diag = d + 1 - query_len;
@@ -2165,7 +2454,7 @@ int wf_swg_max_reach(
                      diag + offs[MAT_SUB*z + p2*y + d]+1 < truth_len &&
                             offs[MAT_SUB*z + p2*y + d]+1 >= offs[MAT_SUB*z + s2*y + d]) {
                 offs[MAT_SUB*z + s2*y + d] = offs[MAT_SUB*z + p2*y + d] + 1;
-                if(print) printf("(S, %d, %d) sub\n", offs[MAT_SUB*z + s2*y + d], 
+                if (Print) printf("(S, %d, %d) sub\n", offs[MAT_SUB*z + s2*y + d], 
                         offs[MAT_SUB*z + s2*y + d]+diag);
             }
 
@@ -2178,7 +2467,7 @@ int wf_swg_max_reach(
                     diag + offs[MAT_SUB*z + p2*y + d-1] < truth_len &&
                            offs[MAT_SUB*z + p2*y + d-1] >= offs[MAT_DEL*z + s2*y + d]) {
                 offs[MAT_DEL*z + s2*y + d] = offs[MAT_SUB*z + p2*y + d-1];
-                if(print) printf("(D, %d, %d) open\n", offs[MAT_DEL*z + s2*y + d], 
+                if (Print) printf("(D, %d, %d) open\n", offs[MAT_DEL*z + s2*y + d], 
                         offs[MAT_DEL*z + s2*y + d]+diag);
             }
             // open gap (enter INS, open fwd only)
@@ -2189,7 +2478,7 @@ int wf_swg_max_reach(
                     diag + offs[MAT_SUB*z + p2*y + d+1]+1 >= 0 &&
                            offs[MAT_SUB*z + p2*y + d+1]+1 >= offs[MAT_INS*z + s2*y + d]) {
                 offs[MAT_INS*z + s2*y + d] = offs[MAT_SUB*z + p2*y + d+1]+1;
-                if(print) printf("(I, %d, %d) open\n", offs[MAT_INS*z + s2*y + d], 
+                if (Print) printf("(I, %d, %d) open\n", offs[MAT_INS*z + s2*y + d], 
                         offs[MAT_INS*z + s2*y + d]+diag);
             }
 
@@ -2205,7 +2494,7 @@ int wf_swg_max_reach(
                          diag + offs[m*z + p2*y + d] < truth_len &&
                                 offs[m*z + p2*y + d] > offs[MAT_SUB*z + s2*y + d]) {
                         offs[MAT_SUB*z + s2*y + d] = offs[m*z + p2*y + d];
-                        if(print) printf("(S, %d, %d) swap rev\n", 
+                        if (Print) printf("(S, %d, %d) swap rev\n", 
                                 offs[m*z + p2*y + d], diag+offs[m*z + p2*y + d]);
                     }
                 }
@@ -2220,7 +2509,7 @@ int wf_swg_max_reach(
                     diag + offs[MAT_DEL*z + p2*y + d-1] < truth_len &&
                            offs[MAT_DEL*z + p2*y + d-1] >= offs[MAT_DEL*z + s2*y + d]) {
                 offs[MAT_DEL*z + s2*y + d] = offs[MAT_DEL*z + p2*y + d-1];
-                if(print) printf("(D, %d, %d) extend\n", offs[MAT_DEL*z + s2*y + d], 
+                if (Print) printf("(D, %d, %d) extend\n", offs[MAT_DEL*z + s2*y + d], 
                         offs[MAT_DEL*z + s2*y + d]+diag);
             }
             // extend gap (stay INS)
@@ -2231,7 +2520,7 @@ int wf_swg_max_reach(
                     diag + offs[MAT_INS*z + p2*y + d+1]+1 >= 0 &&
                            offs[MAT_INS*z + p2*y + d+1]+1 >= offs[MAT_INS*z + s2*y + d]) {
                 offs[MAT_INS*z + s2*y + d] = offs[MAT_INS*z + p2*y + d+1]+1;
-                if(print) printf("(I, %d, %d) extend\n", offs[MAT_INS*z + s2*y + d], 
+                if (Print) printf("(I, %d, %d) extend\n", offs[MAT_INS*z + s2*y + d], 
                         offs[MAT_INS*z + s2*y + d]+diag);
             }
         }
@@ -2253,6 +2542,28 @@ int wf_swg_max_reach(
     return max_reach;
 }
 
+/* Specialized like wf_swg_align(); constant penalties fix the circular score
+ * buffer's size and strides. */
+int wf_swg_max_reach(
+        const seqView & query, const seqView & truth, 
+        std::vector<int> & offs,
+        int main_diag, int main_diag_start, int max_score, 
+        int x, int o, int e, bool print /* false */, bool reverse /* false */
+        ) {
+    if (print)
+        return wf_swg_max_reach_impl<true, 0, 0, 0>(query, truth, offs, 
+                main_diag, main_diag_start, max_score, x, o, e, reverse);
+    else if (x == 5 && o == 6 && e == 2)
+        return wf_swg_max_reach_impl<false, 5, 6, 2>(query, truth, offs, 
+                main_diag, main_diag_start, max_score, x, o, e, reverse);
+    else if (x == 3 && o == 2 && e == 1)
+        return wf_swg_max_reach_impl<false, 3, 2, 1>(query, truth, offs, 
+                main_diag, main_diag_start, max_score, x, o, e, reverse);
+    else
+        return wf_swg_max_reach_impl<false, 0, 0, 0>(query, truth, offs, 
+                main_diag, main_diag_start, max_score, x, o, e, reverse);
+}
+
 
 /* Perform Djikstra Smith-Waterman alignment of two strings, returning 
  * the farthest-reaching reference index of lesser or equal score to that provided.
@@ -2414,6 +2725,102 @@ int swg_max_reach(const std::string & query, const std::string & ref,
 /******************************************************************************/
 
 
+/* Realign clusters [beg, end) of each batch assigned to this thread (every
+ * `nthreads`-th batch, starting at `thread_id`), saving the resulting 
+ * variants of each batch separately.
+ */
+void wf_swg_realign_batches(
+        std::shared_ptr<variantData> vcf, 
+        std::shared_ptr<fastaData> ref_fasta, 
+        const std::vector< std::vector<int> > & batches,
+        std::vector< std::shared_ptr<ctgVariants> > * batch_results,
+        int thread_id, int nthreads,
+        int sub, int open, int extend, bool print) {
+
+    for (int b = thread_id; b < int(batches.size()); b += nthreads) {
+        int hap = batches[b][BATCH_HAP];
+        int ctg = batches[b][BATCH_CTG];
+        std::shared_ptr<ctgVariants> vars = vcf->ctg_variants[hap][ctg];
+        std::shared_ptr<ctgVariants> results(new ctgVariants());
+        (*batch_results)[b] = results;
+
+        // realign each cluster of variants
+        for (int cluster = batches[b][BATCH_BEG]; 
+                cluster < batches[b][BATCH_END]; cluster++) {
+            int beg_idx = vars->clusters[cluster];
+            int end_idx = vars->clusters[cluster+1];
+            int beg = vars->poss[beg_idx]-1;
+            int end = vars->poss[end_idx-1] + vars->rlens[end_idx-1]+1;
+
+            // variant qual is minimum in cluster
+            float qual = g.max_qual;
+            for (int i = beg_idx; i < end_idx; i++) {
+                qual = std::min(qual, vars->var_quals[i]);
+            }
+
+            // an isolated SNP can't be realigned differently (any other path
+            // needs an insertion and a deletion), so skip aligning it
+            if (end_idx-beg_idx == 1 && vars->types[beg_idx] == TYPE_SUB && 
+                    sub < 2*(open+extend) && beg >= 0 && 
+                    end <= ref_fasta->lengths[ctg]) {
+                std::string_view ref_base = ref_fasta->seq(ctg).substr(beg+1, 1);
+                std::string_view alt_base = vars->alt(beg_idx);
+                if (ref_base != alt_base)
+                    results->add_var(beg+1, 1, hap, TYPE_SUB, BED_INSIDE, 
+                            ref_base, alt_base, GT_REF_REF, g.max_qual, int(qual));
+                continue;
+            }
+
+            // generate strings
+            std::string query = 
+                generate_str(ref_fasta, vars, ctg, beg_idx, end_idx, beg, end);
+            std::string_view ref = ref_fasta->seq(ctg).substr(beg, end-beg);
+            
+            // perform alignment
+            if (print) printf("REF:   %.*s\n", int(ref.size()), ref.data());
+            if (print) printf("QUERY: %s\n", query.data());
+            swgWavefronts wf;
+            int s = 0;
+            seqView query_rev(query, true), ref_rev(ref, true); // left-align INDELs
+            wf_swg_align(query_rev, ref_rev, wf, s, sub, open, extend, false);
+            
+            // backtrack
+            std::vector<int> cigar = wf_swg_backtrack(query_rev, ref_rev, wf, 
+                    s, sub, open, extend, false);
+            std::reverse(cigar.begin(), cigar.end());
+            if (print) print_cigar(cigar);
+
+            // compare distances
+            if (print) {
+                int new_score = calc_cig_swg_score(cigar, sub, open, extend);
+                int old_score = calc_vcf_swg_score(vars, cluster, cluster+1, 
+                        sub, open, extend);
+                if (new_score < old_score) {
+                    printf("\n\tCluster %d: %d variants (%d-%d)\n", 
+                        cluster, end_idx-beg_idx, beg_idx, end_idx);
+                    for (int i = beg_idx; i < end_idx; i++) {
+                        printf("\t\t%s %d\t%s\t%s\tQ=%f\n", 
+                            ctg_dict.name(ctg).data(), vars->poss[i], 
+                            vars->ref_lens[i] ? std::string(vars->ref(i)).data() : "_", 
+                            vars->alt_lens[i] ? std::string(vars->alt(i)).data() : "_",
+                            vars->var_quals[i]);
+                    }
+                    printf("Old score: %d\n", old_score);
+                    printf("New score: %d\n", new_score);
+                }
+            }
+            
+            // save resulting variants
+            results->add_variants(cigar, hap, beg, query, ref, qual);
+
+        } // cluster
+    } // batch
+}
+
+
+/******************************************************************************/
+
+
 std::shared_ptr<variantData> wf_swg_realign(
         std::shared_ptr<variantData> vcf, 
         std::shared_ptr<fastaData> ref_fasta, 
@@ -2427,76 +2834,34 @@ std::shared_ptr<variantData> wf_swg_realign(
     std::shared_ptr<variantData> results(new variantData());
     results->set_header(vcf);
 
-    // iterate over each contig haplotype
+    // split each contig haplotype's clusters into batches
+    const int batch_size = 256; // clusters
+    std::vector< std::vector<int> > batches;
     for (int hap = 0; hap < 2; hap++) {
-        for (auto itr = vcf->ctg_variants[hap].begin(); 
-                itr != vcf->ctg_variants[hap].end(); itr++) {
-            std::string ctg = itr->first;
-            std::shared_ptr<ctgVariants> vars = itr->second;
-            if (vars->poss.size() == 0) continue;
-
-            // realign each cluster of variants
-            for (int cluster = 0; cluster < int(vars->clusters.size()-1); cluster++) {
-                int beg_idx = vars->clusters[cluster];
-                int end_idx = vars->clusters[cluster+1];
-                int beg = vars->poss[beg_idx]-1;
-                int end = vars->poss[end_idx-1] + vars->rlens[end_idx-1]+1;
-
-                // variant qual is minimum in cluster
-                float qual = g.max_qual;
-                for (int i = beg_idx; i < end_idx; i++) {
-                    qual = std::min(qual, vars->var_quals[i]);
-                }
-
-                // generate strings
-                std::string query = 
-                    generate_str(ref_fasta, vars, ctg, beg_idx, end_idx, beg, end);
-                std::string ref = ref_fasta->fasta.at(ctg).substr(beg, end-beg);
-                
-                // perform alignment
-                if (print) printf("REF:   %s\n", ref.data());
-                if (print) printf("QUERY: %s\n", query.data());
-                std::vector< std::vector< std::vector<uint8_t> > > ptrs(MATS);
-                std::vector< std::vector< std::vector<int> > > offs(MATS);
-                int s = 0;
-                std::reverse(query.begin(), query.end()); // for left-aligned INDELs
-                std::reverse(ref.begin(), ref.end());
-                wf_swg_align(query, ref, ptrs, offs, s, sub, open, extend, false);
-                
-                // backtrack
-                std::vector<int> cigar = wf_swg_backtrack(query, ref, ptrs, offs, 
-                        s, sub, open, extend, false);
-                std::reverse(query.begin(), query.end());
-                std::reverse(ref.begin(), ref.end());
-                std::reverse(cigar.begin(), cigar.end());
-                if (print) print_cigar(cigar);
-
-                // compare distances
-                if (print) {
-                    int new_score = calc_cig_swg_score(cigar, sub, open, extend);
-                    int old_score = calc_vcf_swg_score(vars, cluster, cluster+1, 
-                            sub, open, extend);
-                    if (new_score < old_score) {
-                        printf("\n\tCluster %d: %d variants (%d-%d)\n", 
-                            cluster, end_idx-beg_idx, beg_idx, end_idx);
-                        for (int i = beg_idx; i < end_idx; i++) {
-                            printf("\t\t%s %d\t%s\t%s\tQ=%f\n", 
-                                ctg.data(), vars->poss[i], 
-                                vars->refs[i].size() ?  vars->refs[i].data() : "_", 
-                                vars->alts[i].size() ?  vars->alts[i].data() : "_",
-                                vars->var_quals[i]);
-                        }
-                        printf("Old score: %d\n", old_score);
-                        printf("New score: %d\n", new_score);
-                    }
-                }
-                
-                // save resulting variants
-                results->add_variants(cigar, hap, beg, ctg, query, ref, qual);
+        for (int ctg = 0; ctg < int(vcf->ctg_variants[hap].size()); ctg++) {
+            std::shared_ptr<ctgVariants> vars = vcf->ctg_variants[hap][ctg];
+            if (vars == nullptr || vars->poss.size() == 0) continue;
+            int nclusters = vars->clusters.size()-1;
+            for (int beg = 0; beg < nclusters; beg += batch_size)
+                batches.push_back({hap, ctg, beg, std::min(beg+batch_size, nclusters)});
+        }
+    }
 
-            } // cluster
-        } // contig
-    } // hap
+    // realign batches in parallel (serially if printing)
+    std::vector< std::shared_ptr<ctgVariants> > batch_results(batches.size());
+    int nthreads = print ? 1 : std::max(1, std::min(g.max_threads, int(batches.size())));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; t++)
+        threads.push_back(std::thread(wf_swg_realign_batches, vcf, ref_fasta,
+                    std::cref(batches), &batch_results, t, nthreads,
+                    sub, open, extend, print));
+    for (auto & t : threads)
+        t.join();
+
+    // concatenate batches in order
+    for (size_t b = 0; b < batches.size(); b++)
+        results->ctg_variants[batches[b][BATCH_HAP]][batches[b][BATCH_CTG]]->append(
+                *batch_results[b]);
 
     return results;
 }
@@ -2535,10 +2900,9 @@ int count_dist(const std::vector<int> & cigar) {
 
 /* After alignment, backtrack using pointers and save cigar. */
 std::vector<int> wf_swg_backtrack(
-        const std::string & query,
-        const std::string & ref,
-        const std::vector< std::vector< std::vector<uint8_t> > > & ptrs, 
-        const std::vector< std::vector< std::vector<int> > > & offs, 
+        const seqView & query,
+        const seqView & ref,
+        swgWavefronts & wf,
         int s, int x, int o, int e,
         bool print) {
 
@@ -2565,14 +2929,15 @@ std::vector<int> wf_swg_backtrack(
         // debug print
         if (s < 0) ERROR("Negative wf_swg_backtrack() score at (%c, %d, %d)",
                 std::string("SID")[pos.mi], pos.qi, pos.ri);
+        wf_swg_restore(query, ref, wf, s, x, o, e);
 
         // init
         int diag = pos.ri - pos.qi;
         int d = query.size()-1 + diag;
         
         if (pos.mi == MAT_SUB) {
-            if (ptrs[MAT_SUB][s][d] & PTR_INS) { // end INS freely
-                int prev_off = offs[MAT_INS][s][d];
+            if (wf.ptr(MAT_SUB, s, d) & PTR_INS) { // end INS freely
+                int prev_off = wf.off(MAT_INS, s, d);
                 while (pos.qi > prev_off) { // match
                     if (print) printf("(%c, %d, %d) match ins\n",
                             std::string("SID")[pos.mi], pos.qi, pos.ri);
@@ -2582,8 +2947,8 @@ std::vector<int> wf_swg_backtrack(
                             std::string("SID")[pos.mi], pos.qi, pos.ri);
                 }
                 pos.mi = MAT_INS;
-            } else if (ptrs[MAT_SUB][s][d] & PTR_DEL) { // end DEL freely
-                int prev_off = offs[MAT_DEL][s][d];
+            } else if (wf.ptr(MAT_SUB, s, d) & PTR_DEL) { // end DEL freely
+                int prev_off = wf.off(MAT_DEL, s, d);
                 while (pos.qi > prev_off) { // match
                     if (print) printf("(%c, %d, %d) match del\n",
                             std::string("SID")[pos.mi], pos.qi, pos.ri);
@@ -2593,9 +2958,10 @@ std::vector<int> wf_swg_backtrack(
                             std::string("SID")[pos.mi], pos.qi, pos.ri);
                 }
                 pos.mi = MAT_DEL;
-            } else if (ptrs[MAT_SUB][s][d] & PTR_SUB) { // sub
+            } else if (wf.ptr(MAT_SUB, s, d) & PTR_SUB) { // sub
                 if (s-x < 0) ERROR("Unexpected PTR_SUB");
-                int prev_off = offs[MAT_SUB][s-x][d];
+                wf_swg_restore(query, ref, wf, s-x, x, o, e);
+                int prev_off = wf.off(MAT_SUB, s-x, d);
                 while (pos.qi > prev_off+1) { // match
                     if (print) printf("(%c, %d, %d) match sub\n",
                             std::string("SID")[pos.mi], pos.qi, pos.ri);
@@ -2609,7 +2975,7 @@ std::vector<int> wf_swg_backtrack(
                 pos.qi--; cigar[cigar_ptr--] = PTR_SUB;
                 pos.ri--; cigar[cigar_ptr--] = PTR_SUB;
                 s -= x;
-            } else if (ptrs[MAT_SUB][s][d] & PTR_MAT) { // only matches remain
+            } else if (wf.ptr(MAT_SUB, s, d) & PTR_MAT) { // only matches remain
                 while (pos.qi >= 0 && pos.ri >= 0) { // match
                     if (print) printf("(%c, %d, %d) match mat\n",
                             std::string("SID")[pos.mi], pos.qi, pos.ri);
@@ -2621,16 +2987,16 @@ std::vector<int> wf_swg_backtrack(
                         std::string("SID")[pos.mi], pos.qi, pos.ri);
             } else {
                 ERROR("Unexpected pointer '%d' in wf_swg_backtrack() at (%c, %d, %d)",
-                    ptrs[MAT_SUB][s][d], std::string("SID")[pos.mi], pos.qi, pos.ri);
+                    wf.ptr(MAT_SUB, s, d), std::string("SID")[pos.mi], pos.qi, pos.ri);
             }
 
         } else if (pos.mi == MAT_INS) {
-            if (ptrs[MAT_INS][s][d] & PTR_INS) { // extend INS
+            if (wf.ptr(MAT_INS, s, d) & PTR_INS) { // extend INS
                 if (print) printf("(%c, %d, %d) ext ins\n",
                         std::string("SID")[pos.mi], pos.qi, pos.ri);
                 pos.qi--; cigar[cigar_ptr--] = PTR_INS;
                 s -= e;
-            } else if (ptrs[MAT_INS][s][d] & PTR_SUB) { // start INS
+            } else if (wf.ptr(MAT_INS, s, d) & PTR_SUB) { // start INS
                 if (print) printf("(%c, %d, %d) start ins\n",
                         std::string("SID")[pos.mi], pos.qi, pos.ri);
                 pos.qi--; cigar[cigar_ptr--] = PTR_INS;
@@ -2638,16 +3004,16 @@ std::vector<int> wf_swg_backtrack(
                 s -= o + e;
             } else {
                 ERROR("Unexpected pointer '%d' in wf_swg_backtrack() at (%c, %d, %d)",
-                    ptrs[MAT_INS][s][d], std::string("SID")[pos.mi], pos.qi, pos.ri);
+                    wf.ptr(MAT_INS, s, d), std::string("SID")[pos.mi], pos.qi, pos.ri);
             }
 
         } else if (pos.mi == MAT_DEL) {
-            if (ptrs[MAT_DEL][s][d] & PTR_DEL) { // extend DEL
+            if (wf.ptr(MAT_DEL, s, d) & PTR_DEL) { // extend DEL
                 if (print) printf("(%c, %d, %d) ext del\n",
                         std::string("SID")[pos.mi], pos.qi, pos.ri);
                 pos.ri--; cigar[cigar_ptr--] = PTR_DEL;
                 s -= e;
-            } else if (ptrs[MAT_DEL][s][d] & PTR_SUB) { // start DEL
+            } else if (wf.ptr(MAT_DEL, s, d) & PTR_SUB) { // start DEL
                 if (print) printf("(%c, %d, %d) start del\n",
                         std::string("SID")[pos.mi], pos.qi, pos.ri);
                 pos.ri--; cigar[cigar_ptr--] = PTR_DEL;
@@ -2655,7 +3021,7 @@ std::vector<int> wf_swg_backtrack(
                 s -= o + e;
             } else {
                 ERROR("Unexpected pointer '%d' in wf_swg_backtrack() at (%c, %d, %d)",
-                    ptrs[MAT_DEL][s][d], std::string("SID")[pos.mi], pos.qi, pos.ri);
+                    wf.ptr(MAT_DEL, s, d), std::string("SID")[pos.mi], pos.qi, pos.ri);
             }
 
         } else {
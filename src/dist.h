@@ -3,6 +3,14 @@
 
 #include <unordered_set>
 #include <unordered_map>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "fasta.h"
 #include "variant.h"
@@ -11,6 +19,153 @@
 #include "edit.h"
 
 
+/* Read-only view of a sequence slice. A reversed view maps index i to
+ * seq[size-1-i], so reverse alignments need no reversed copies.
+ */
+class seqView {
+public:
+    seqView(std::string_view seq, bool rev = false) : seq(seq), rev(rev) {;}
+    seqView(const std::string & seq, bool rev = false) : seq(seq), rev(rev) {;}
+
+    char operator[](int i) const { 
+        return this->rev ? this->seq[this->seq.size()-1-i] : this->seq[i]; }
+    int size() const { return this->seq.size(); }
+
+    std::string_view seq;
+    bool rev;
+};
+
+/* Length of the longest common prefix of `a` (from `ai`) and `b` (from `bi`),
+ * up to `limit` bases; shared by all wavefront aligners to extend diagonals.
+ * When both views have the same direction, the first eight bases are compared
+ * as one 64-bit word (most runs between variants are short), then sixteen per
+ * SSE2 step, locating the first mismatch from the trailing (or, reversed, 
+ * leading) zero bits of the mismatch mask.
+ */
+inline int extend_match(const seqView & a, int ai, const seqView & b, int bi, int limit) {
+    int len = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t wa, wb;
+    if (!a.rev && !b.rev) {
+        const char * pa = a.seq.data() + ai;
+        const char * pb = b.seq.data() + bi;
+        if (limit >= 8) {
+            memcpy(&wa, pa, 8);
+            memcpy(&wb, pb, 8);
+            if (wa != wb) return __builtin_ctzll(wa ^ wb) / 8;
+            len = 8;
+        }
+#ifdef __SSE2__
+        for (; len + 16 <= limit; len += 16) {
+            unsigned mask = 0xFFFF ^ _mm_movemask_epi8(_mm_cmpeq_epi8(
+                    _mm_loadu_si128((const __m128i *) (pa + len)),
+                    _mm_loadu_si128((const __m128i *) (pb + len))));
+            if (mask) return len + __builtin_ctz(mask);
+        }
+#endif
+        for (; len + 8 <= limit; len += 8) {
+            memcpy(&wa, pa + len, 8);
+            memcpy(&wb, pb + len, 8);
+            if (wa != wb) return len + __builtin_ctzll(wa ^ wb) / 8;
+        }
+    } else if (a.rev && b.rev) { // walk backwards, last byte is most significant
+        const char * pa = a.seq.data() + a.size()-1 - ai;
+        const char * pb = b.seq.data() + b.size()-1 - bi;
+        if (limit >= 8) {
+            memcpy(&wa, pa - 7, 8);
+            memcpy(&wb, pb - 7, 8);
+            if (wa != wb) return __builtin_clzll(wa ^ wb) / 8;
+            len = 8;
+        }
+#ifdef __SSE2__
+        for (; len + 16 <= limit; len += 16) {
+            unsigned mask = 0xFFFF ^ _mm_movemask_epi8(_mm_cmpeq_epi8(
+                    _mm_loadu_si128((const __m128i *) (pa - len - 15)),
+                    _mm_loadu_si128((const __m128i *) (pb - len - 15))));
+            if (mask) return len + __builtin_clz(mask) - 16;
+        }
+#endif
+        for (; len + 8 <= limit; len += 8) {
+            memcpy(&wa, pa - len - 7, 8);
+            memcpy(&wb, pb - len - 7, 8);
+            if (wa != wb) return len + __builtin_clzll(wa ^ wb) / 8;
+        }
+    }
+#endif
+    while (len < limit && a[ai+len] == b[bi+len]) len++;
+    return len;
+}
+
+/* Offsets and pointers of each wf_swg_align() wavefront. Each score only 
+ * stores its explored diagonals [lo, hi] (shared by all matrices), so memory
+ * grows with the alignment band rather than the full anti-diagonal. 
+ * Diagonals outside the band read as unreached.
+ *
+ * Once more than `max_cells` cells are stored, alignment switches to 
+ * checkpointing: only the last `window` wavefronts before each multiple of
+ * `interval` (`checkpoints` windows) are kept (enough to resume from there), and wf_swg_backtrack()
+ * recomputes released wavefronts one interval at a time. Recomputed 
+ * wavefronts are identical, so the CIGAR is unchanged.
+ */
+#define WF_MAX_CELLS   (1 << 22)
+#define WF_CHECKPOINTS 32 // checkpoint interval, in windows
+
+class swgWavefronts {
+public:
+    swgWavefronts() : offs(MATS), ptrs(MATS) {;}
+
+    void add(int lo, int hi) { // append next score's wavefront
+        this->lo.push_back(lo);
+        this->hi.push_back(hi);
+        for (int m = 0; m < MATS; m++) {
+            this->offs[m].emplace_back();
+            this->ptrs[m].emplace_back();
+        }
+        this->released.push_back(true);
+        this->alloc(this->lo.size()-1);
+    }
+    void alloc(int s) { // (re-)allocate released wavefront as unreached
+        int width = std::max(0, this->hi[s]-this->lo[s]+1);
+        for (int m = 0; m < MATS; m++) {
+            this->offs[m][s].assign(width, -2);
+            this->ptrs[m][s].assign(width, PTR_NONE);
+        }
+        this->released[s] = false;
+        this->cells += width;
+    }
+    void release(int s) {
+        if (this->released[s]) return;
+        for (int m = 0; m < MATS; m++) {
+            std::vector<int>().swap(this->offs[m][s]);
+            std::vector<uint8_t>().swap(this->ptrs[m][s]);
+        }
+        this->released[s] = true;
+        this->cells -= std::max(0, this->hi[s]-this->lo[s]+1);
+    }
+    bool checkpoint(int s) const {
+        return s == 0 || s % this->interval >= this->interval - this->window; }
+
+    int off(int m, int s, int d) const {
+        return d >= this->lo[s] && d <= this->hi[s] ? 
+            this->offs[m][s][d - this->lo[s]] : -2; }
+    uint8_t ptr(int m, int s, int d) const {
+        return d >= this->lo[s] && d <= this->hi[s] ? 
+            this->ptrs[m][s][d - this->lo[s]] : PTR_NONE; }
+
+    std::vector<int> lo;                                     // per score
+    std::vector<int> hi;
+    std::vector< std::vector< std::vector<int> > > offs;     // [mat][score][d-lo]
+    std::vector< std::vector< std::vector<uint8_t> > > ptrs;
+
+    std::vector<bool> released;      // per score, storage freed
+    long cells = 0;                  // stored cells per matrix
+    int window = 0;                  // previous scores a wavefront depends on
+    int interval = 0;                // checkpoint interval, 0 if all kept
+    long max_cells = WF_MAX_CELLS;   // stored cells before checkpointing
+    int checkpoints = WF_CHECKPOINTS;
+    std::vector<int> rows[4];        // scratch source rows for wf_step()
+};
+
 class idx1 {
 public:
     int hi;  // hap idx1
@@ -103,7 +258,7 @@ void generate_ptrs_strs(
         std::shared_ptr<ctgVariants> query_vars,
         size_t query_clust_beg_idx, size_t ref_clust_beg_idx,
         int beg_pos, int end_pos, std::shared_ptr<fastaData> ref, 
-        const std::string & ctg
+        int ctg
         );
 
 void reverse_ptrs_strs(
@@ -114,11 +269,24 @@ void reverse_ptrs_strs(
 
 std::string generate_str(
         std::shared_ptr<fastaData> ref, 
-        std::shared_ptr<ctgVariants> vars, const std::string & ctg,
+        std::shared_ptr<ctgVariants> vars, int ctg,
         int var_idx, int end_idx, int beg_pos, int end_pos, int min_qual=0);
 
 /******************************************************************************/
 
+void calc_prec_recall_score(
+        const std::string & query1, const std::string & query2,
+        const std::string & truth1, const std::string & truth2, 
+        const std::string & ref,
+        const std::vector< std::vector<int> > & query1_ref_ptrs, 
+        const std::vector< std::vector<int> > & ref_query1_ptrs,
+        const std::vector< std::vector<int> > & query2_ref_ptrs, 
+        const std::vector< std::vector<int> > & ref_query2_ptrs,
+        const std::vector< std::vector<int> > & truth1_ref_ptrs, 
+        const std::vector< std::vector<int> > & truth2_ref_ptrs,
+        std::vector<int> & s, int aln_start, int aln_stop
+        );
+
 void calc_prec_recall_aln(
         const std::string & query1, const std::string & query2,
         const std::string & truth1, const std::string & truth2, 
@@ -172,8 +340,7 @@ void get_prec_recall_path_sync(
         );
 
 void calc_prec_recall(
-        superclusterData * clusterdata_ptr, int sc_idx, 
-        const std::string & ctg, 
+        superclusterData * clusterdata_ptr, int sc_idx, int ctg,
         const std::string & ref,
         const std::string & query1, const std::string & query2, 
         const std::string & truth1, const std::string & truth2, 
@@ -204,7 +371,7 @@ int swg_max_reach(
         int ref_section = -1);
 
 int wf_swg_max_reach(
-        const std::string & query, const std::string & truth, 
+        const seqView & query, const seqView & truth, 
         std::vector<int> & offs,
         int main_diag, int main_diag_start, int max_score, 
         int x, int o, int e, bool print = false, bool reverse = false
@@ -216,23 +383,20 @@ std::shared_ptr<variantData> wf_swg_realign(
         int sub, int open, int extend, int callset, bool print = false);
 
 void wf_swg_align(
-        const std::string & query, 
-        const std::string & truth,
-        const std::vector< std::vector< std::vector<uint8_t> > > & ptrs,
-        const std::vector< std::vector< std::vector<int> > > & offs,
+        const seqView & query, 
+        const seqView & truth,
+        swgWavefronts & wf,
         int & s, int sub, int open, int extend, bool print = false);
 
 std::vector<int> wf_swg_backtrack(
-        const std::string & query, 
-        const std::string & truth,
-        const std::vector< std::vector< std::vector<uint8_t> > > & ptrs,
-        const std::vector< std::vector< std::vector<int> > > & offs,
+        const seqView & query, 
+        const seqView & truth,
+        swgWavefronts & wf,
         int s, int sub, int open, int extend, bool print = false);
 
-void wf_ed(
-        const std::string & query, const std::string & truth, int & s, 
-        std::vector< std::vector<int> > & offs,
-        std::vector< std::vector<int> > & ptrs);
+int wf_ed(
+        const seqView & query, const seqView & truth, 
+        std::vector<int> & offs);
 
 
 int count_dist(const std::vector<int> & cigar);
@@ -1,7 +1,7 @@
 #include "edit.h"
 #include "globals.h"
 
-void editData::add_edits(const std::string & ctg, int pos, uint8_t hap,
+void editData::add_edits(int ctg, int pos, uint8_t hap,
         const std::vector<int> & cig, int sc, int qual) {
    int cig_ptr = 0;
    int type = PTR_MAT;
@@ -76,7 +76,7 @@ void editData::add_edits(const std::string & ctg, int pos, uint8_t hap,
    }
 }
 
-void editData::add_edit(const std::string & ctg, int pos, uint8_t hap,
+void editData::add_edit(int ctg, int pos, uint8_t hap,
         uint8_t type, int len, int sc, int qual) {
     this->ctgs.push_back(ctg);
     this->poss.push_back(pos);
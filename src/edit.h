@@ -16,9 +16,9 @@ public:
     editData() {};
 
     // helper functions
-    void add_edits(const std::string & ctg, int pos, uint8_t hap, 
+    void add_edits(int ctg, int pos, uint8_t hap, 
             const std::vector<int> & cig, int sc, int qual);
-    void add_edit(const std::string & ctg, int pos, uint8_t hap, 
+    void add_edit(int ctg, int pos, uint8_t hap, 
             uint8_t type, int len, int sc, int qual);
 
     int get_ed(int qual, int type=TYPE_ALL) const; // edit distance
@@ -26,7 +26,7 @@ public:
     int get_score(int qual) const;                 // smith-waterman distance
 
     // data (all of size n)
-    std::vector<std::string> ctgs;  // contigs
+    std::vector<int> ctgs;          // contig IDs
     std::vector<int> poss;          // variant start positions (0-based)
     std::vector<uint8_t> haps;      // variant haplotypes
     std::vector<uint8_t> types;     // variant type: NONE, SUB, INS, DEL, GRP
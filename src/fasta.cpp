@@ -0,0 +1,206 @@
+#include <cstring>
+#include <filesystem>
+
+#include "fasta.h"
+#include "globals.h"
+#include "file.h"
+
+#include "htslib/kseq.h"
+KSEQ_INIT(BGZF*, bgzf_read);
+
+const char VDR_MAGIC[4] = {'V', 'D', 'R', '\0'};
+
+/* Size and modification time of the FASTA a reference image was built from. */
+bool fasta_stamp(const std::string & ref_fasta_fn, 
+        uint64_t & size, int64_t & mtime) {
+    std::error_code ec;
+    size = std::filesystem::file_size(ref_fasta_fn, ec);
+    if (ec) return false;
+    mtime = std::filesystem::last_write_time(ref_fasta_fn, ec)
+        .time_since_epoch().count();
+    return !ec;
+}
+
+/******************************************************************************/
+
+fastaData::fastaData(const std::string & ref_fasta_fn, BGZF * ref_fasta_fp) {
+
+    // map preprocessed reference image, if available
+    if (this->load_image(ref_fasta_fn + ".vdr", ref_fasta_fn)) {
+        bgzf_close(ref_fasta_fp);
+        return;
+    }
+
+    // use (or build) FASTA index, deferring sequence reads until needed
+    this->fai = fai_load(ref_fasta_fn.data());
+    if (this->fai != NULL) {
+        bgzf_close(ref_fasta_fp);
+        for (int i = 0; i < faidx_nseq(this->fai); i++) {
+            const char * name = faidx_iseq(this->fai, i);
+            int ctg = ctg_dict.id(name);
+            if (ctg >= int(this->fasta.size())) {
+                this->fasta.resize(ctg+1);
+                this->lengths.resize(ctg+1, -1);
+            }
+            this->lengths[ctg] = faidx_seq_len64(this->fai, name);
+        }
+        this->loaded.reset(new std::once_flag[this->fasta.size()]);
+        return;
+    }
+
+    // unindexable (e.g. gzip-compressed) FASTA, read all sequences
+    WARN("Failed to load or build index for reference FASTA '%s', reading entire file", 
+            ref_fasta_fn.data());
+    kseq_t * seq = kseq_init(ref_fasta_fp);
+    while (kseq_read(seq) >= 0) {
+        int ctg = ctg_dict.id(seq->name.s);
+        if (ctg >= int(this->fasta.size())) {
+            this->fasta.resize(ctg+1);
+            this->lengths.resize(ctg+1, -1);
+        }
+        this->fasta[ctg] = seq->seq.s;
+        this->lengths[ctg] = this->fasta[ctg].size();
+    }
+    kseq_destroy(seq);
+    bgzf_close(ref_fasta_fp);
+}
+
+
+fastaData::~fastaData() {
+    if (this->fai != NULL) fai_destroy(this->fai);
+}
+
+
+/* Map the reference image, returning false if it is missing or unusable. The
+ * image holds all sequences back to back, followed by the contig table and 
+ * finally the table's offset.
+ */
+bool fastaData::load_image(const std::string & image_fn, 
+        const std::string & ref_fasta_fn) {
+
+    std::unique_ptr<mappedFile> in(new mappedFile(image_fn));
+    if (in->data == NULL) return false;
+
+    char magic[sizeof(VDR_MAGIC)];
+    int version = 0;
+    uint64_t table_off = 0;
+    bool ok = in->read(magic, sizeof(magic)) &&
+            memcmp(magic, VDR_MAGIC, sizeof(VDR_MAGIC)) == 0 &&
+            in->read_int(version) && version == VDR_VERSION &&
+            in->size >= in->pos + sizeof(table_off);
+    if (ok) {
+        in->pos = in->size - sizeof(table_off);
+        ok = in->read(&table_off, sizeof(table_off)) && 
+            table_off <= in->size - sizeof(table_off);
+        in->pos = table_off;
+    }
+
+    // skip images of a since-modified FASTA
+    uint64_t size = 0, ref_size = 0;
+    int64_t mtime = 0, ref_mtime = 0;
+    ok = ok && in->read(&size, sizeof(size)) && in->read(&mtime, sizeof(mtime));
+    if (ok && (!fasta_stamp(ref_fasta_fn, ref_size, ref_mtime) || 
+                size != ref_size || mtime != ref_mtime)) {
+        WARN("Ignoring out-of-date reference image '%s', rerun 'vcfdist index'", 
+                image_fn.data());
+        return false;
+    }
+
+    int nctg = 0;
+    ok = ok && in->read_int(nctg) && nctg >= 0;
+    std::vector<std::string> names(std::max(nctg, 0));
+    std::vector<int> lengths(std::max(nctg, 0), 0);
+    std::vector<uint64_t> offs(std::max(nctg, 0), 0);
+    for (int i = 0; ok && i < nctg; i++) {
+        ok = in->read_str(names[i]) && in->read_int(lengths[i]) && 
+            in->read(&offs[i], sizeof(offs[i])) && lengths[i] >= 0 &&
+            offs[i] + lengths[i] <= table_off;
+    }
+    if (!ok || in->pos != in->size - sizeof(table_off)) {
+        WARN("Ignoring invalid reference image '%s'", image_fn.data());
+        return false;
+    }
+
+    for (int i = 0; i < nctg; i++) {
+        int ctg = ctg_dict.id(names[i]);
+        if (ctg >= int(this->fasta.size())) {
+            this->fasta.resize(ctg+1);
+            this->lengths.resize(ctg+1, -1);
+            this->image_offs.resize(ctg+1, 0);
+        }
+        this->lengths[ctg] = lengths[i];
+        this->image_offs[ctg] = offs[i];
+    }
+    if (g.verbosity >= 1) INFO("  Mapped reference image '%s'", image_fn.data());
+    this->image_seqs = in->data;
+    this->image = std::move(in);
+    return true;
+}
+
+
+/* Fetch contig `ctg` from the indexed FASTA, called once per contig. */
+void fastaData::load(int ctg) const {
+    if (this->lengths[ctg] == 0) return;
+    std::lock_guard<std::mutex> lock(this->fai_mtx);
+    hts_pos_t len = 0;
+    char * seq = faidx_fetch_seq64(this->fai, ctg_dict.name(ctg).data(),
+            0, this->lengths[ctg]-1, &len);
+    if (seq == NULL || len != this->lengths[ctg])
+        ERROR("Failed to read contig '%s' from reference FASTA '%s'",
+                ctg_dict.name(ctg).data(), g.ref_fasta_fn.data());
+    this->fasta[ctg].assign(seq, len);
+    free(seq);
+}
+
+
+/******************************************************************************/
+
+/* Write the reference image for `ref_fasta_fn` to '<ref_fasta_fn>.vdr'. Sequences
+ * are stored as-is, so results match those from reading the FASTA directly.
+ */
+void write_fasta_image(const std::string & ref_fasta_fn) {
+    BGZF * fp = bgzf_open(ref_fasta_fn.data(), "r");
+    if (fp == NULL)
+        ERROR("Failed to open reference FASTA file '%s'", ref_fasta_fn.data());
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if (!fasta_stamp(ref_fasta_fn, size, mtime))
+        ERROR("Failed to stat reference FASTA file '%s'", ref_fasta_fn.data());
+
+    std::string image_fn = ref_fasta_fn + ".vdr";
+    if (g.verbosity >= 1) INFO("Writing reference image '%s'", image_fn.data());
+    fileWriter out(image_fn);
+    out.write(VDR_MAGIC, sizeof(VDR_MAGIC));
+    out.write_int(VDR_VERSION);
+
+    // write sequences, saving contig table for the end
+    std::vector<std::string> names;
+    std::vector<int> lengths;
+    std::vector<uint64_t> offs;
+    uint64_t off = sizeof(VDR_MAGIC) + sizeof(int);
+    kseq_t * seq = kseq_init(fp);
+    int ret = 0;
+    while ((ret = kseq_read(seq)) >= 0) {
+        names.push_back(seq->name.s);
+        lengths.push_back(seq->seq.l);
+        offs.push_back(off);
+        out.write(seq->seq.s, seq->seq.l);
+        off += seq->seq.l;
+    }
+    kseq_destroy(seq);
+    bgzf_close(fp);
+    if (ret < -1) 
+        ERROR("Failed to parse reference FASTA file '%s'", ref_fasta_fn.data());
+
+    out.write(&size, sizeof(size));
+    out.write(&mtime, sizeof(mtime));
+    out.write_int(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        out.write_str(names[i]);
+        out.write_int(lengths[i]);
+        out.write(&offs[i], sizeof(offs[i]));
+    }
+    out.write(&off, sizeof(off));
+    out.close();
+    if (g.verbosity >= 1) INFO("  Wrote %d contigs", int(names.size()));
+}
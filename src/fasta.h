@@ -2,27 +2,110 @@
 #define _FASTA_H_
 
 #include <string>
+#include <string_view>
+#include <deque>
+#include <vector>
 #include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 
-// zlib is required for kseq
-#include "zlib.h"
-#include "htslib/kseq.h"
-KSEQ_INIT(int, read);
+#include "htslib/bgzf.h"
+#include "htslib/faidx.h"
 
+/* Maps contig names to dense integer IDs, which index all per-contig data.
+ * Contigs are registered while the FASTA, VCF headers and BED are read
+ * (possibly concurrently), so all accesses are locked.
+ */
+class contigDict {
+public:
+    contigDict() {;}
+
+    int id(const std::string & name) { // add contig if new
+        std::lock_guard<std::mutex> lock(this->mtx);
+        auto itr = this->ids.find(name);
+        if (itr != this->ids.end()) return itr->second;
+        this->ids[name] = this->names.size();
+        this->names.push_back(name);
+        return this->names.size()-1;
+    }
+    int find(const std::string & name) const { // -1 if not present
+        std::lock_guard<std::mutex> lock(this->mtx);
+        auto itr = this->ids.find(name);
+        return itr == this->ids.end() ? -1 : itr->second;
+    }
+    const std::string & name(int id) const {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        return this->names.at(id);
+    }
+    int size() const {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        return this->names.size();
+    }
+
+private:
+    std::deque<std::string> names;   // stable references while growing
+    std::unordered_map<std::string, int> ids;
+    mutable std::mutex mtx;
+};
+
+// defined in main.cpp
+extern contigDict ctg_dict;
+
+class mappedFile;
+
+// bump whenever the reference image layout changes
+#define VDR_VERSION 1
+
+/* Reference sequences, indexed by contig ID. If an up-to-date reference image
+ * ('<ref.fasta>.vdr', written by 'vcfdist index') exists, it is mapped 
+ * read-only, so concurrent processes share one copy through the page cache.
+ * Failing that, when the FASTA is indexed (or an index can be built), only
+ * contig names and lengths are read up front, and each contig is fetched on
+ * first use; contigs never referenced by the VCFs or BED are never read. 
+ * Otherwise, the entire FASTA is read immediately.
+ */
 class fastaData {
 public:
-    fastaData(FILE * ref_fasta_fp) {
-        kseq_t * seq = kseq_init(fileno(ref_fasta_fp));
-        while (kseq_read(seq) >= 0) {
-            this->fasta[seq->name.s] = seq->seq.s;
-            this->lengths[seq->name.s] = this->fasta.at(seq->name.s).size();
-        }
-        kseq_destroy(seq);
-        fclose(ref_fasta_fp);
+    fastaData(const std::string & ref_fasta_fn, BGZF * ref_fasta_fp);
+    ~fastaData();
+
+    bool contains(int ctg) const {
+        return ctg >= 0 && ctg < int(this->lengths.size()) &&
+            this->lengths[ctg] >= 0;
+    }
+    std::string_view seq(int ctg) const {
+        if (!this->contains(ctg)) throw std::out_of_range("fastaData::seq");
+        if (this->image_seqs != NULL)
+            return std::string_view(this->image_seqs + this->image_offs[ctg], 
+                    this->lengths[ctg]);
+        if (this->fai != NULL)
+            std::call_once(this->loaded[ctg], &fastaData::load, this, ctg);
+        return this->fasta[ctg];
+    }
+    void erase(int ctg) {
+        if (!this->contains(ctg)) return;
+        std::string().swap(this->fasta[ctg]);
+        this->lengths[ctg] = -1;
     }
-    
-    std::unordered_map<std::string,std::string> fasta;
-    std::unordered_map<std::string,int> lengths;
+
+    // indexed by contig ID, length -1 if contig is not in FASTA
+    mutable std::vector<std::string> fasta;
+    std::vector<int> lengths;
+
+private:
+    bool load_image(const std::string & image_fn, const std::string & ref_fasta_fn);
+    void load(int ctg) const;
+
+    std::unique_ptr<mappedFile> image; // NULL if no reference image
+    const char * image_seqs = NULL;
+    std::vector<size_t> image_offs;
+
+    faidx_t * fai = NULL;            // NULL if entire FASTA was read
+    mutable std::mutex fai_mtx;      // faidx handle is not thread-safe
+    std::unique_ptr<std::once_flag[]> loaded;
 };
 
+void write_fasta_image(const std::string & ref_fasta_fn);
+
 #endif
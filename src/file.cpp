@@ -0,0 +1,79 @@
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "file.h"
+#include "globals.h"
+
+fileWriter::fileWriter(const std::string & fn) {
+    this->filename = fn;
+    this->tmp_filename = fn + ".tmp" + std::to_string(getpid());
+    this->fp = fopen(this->tmp_filename.data(), "wb");
+    if (this->fp == NULL)
+        ERROR("Failed to open file '%s'", this->tmp_filename.data());
+}
+
+void fileWriter::write(const void * data, size_t size) {
+    if (size && fwrite(data, 1, size, this->fp) != size)
+        ERROR("Failed to write file '%s'", this->tmp_filename.data());
+}
+
+void fileWriter::write_str(const std::string & str) {
+    this->write_int(str.size());
+    this->write(str.data(), str.size());
+}
+
+void fileWriter::close() {
+    if (fclose(this->fp) != 0 ||
+            rename(this->tmp_filename.data(), this->filename.data()) != 0)
+        ERROR("Failed to write file '%s'", this->filename.data());
+}
+
+/******************************************************************************/
+
+mappedFile::mappedFile(const std::string & fn) {
+    int fd = open(fn.data(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void * map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            this->data = (const char *) map;
+            this->size = st.st_size;
+            this->mapped = true;
+        }
+    }
+    if (!this->mapped) { // e.g. BED passed as a pipe
+        char buf[1 << 16];
+        ssize_t n = 0;
+        while ((n = ::read(fd, buf, sizeof(buf))) > 0)
+            this->buffer.append(buf, n);
+        if (n == 0) {
+            this->data = this->buffer.data();
+            this->size = this->buffer.size();
+        }
+    }
+    ::close(fd);
+}
+
+mappedFile::~mappedFile() {
+    if (this->mapped) munmap((void *) this->data, this->size);
+}
+
+bool mappedFile::read(void * dst, size_t size) {
+    if (this->data == NULL || this->pos + size > this->size) return false;
+    if (size) memcpy(dst, this->data + this->pos, size);
+    this->pos += size;
+    return true;
+}
+
+bool mappedFile::read_str(std::string & str) {
+    int len = 0;
+    if (!this->read_int(len) || len < 0 || this->pos + len > this->size)
+        return false;
+    str.assign(this->data + this->pos, len);
+    this->pos += len;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef _FILE_H_
+#define _FILE_H_
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "defs.h"
+
+/* Binary file writer, used for caches and reference images. Writes to a 
+ * temporary file which close() renames, so concurrent runs never see a
+ * partially written file.
+ */
+class fileWriter {
+public:
+    fileWriter(const std::string & fn);
+
+    void write(const void * data, size_t size);
+    template <typename T> void write_vector(const std::vector<T> & v) {
+        this->write(v.data(), v.size() * sizeof(T)); }
+    void write_int(int x) { this->write(&x, sizeof(x)); }
+    void write_str(const std::string & str);
+    void close();
+
+    FILE* fp;
+    std::string filename;
+    std::string tmp_filename;
+};
+
+/* Read-only view of an entire file. Regular files are mapped; pipes, empty 
+ * files and files that fail to map are read into memory instead. `data` is 
+ * NULL only if the file could not be opened or read.
+ */
+class mappedFile {
+public:
+    mappedFile(const std::string & fn);
+    ~mappedFile();
+
+    bool read(void * data, size_t size);
+    template <typename T> bool read_vector(std::vector<T> & v, int n) {
+        if (n < 0) return false;
+        v.resize(n);
+        return this->read(v.data(), n * sizeof(T)); }
+    bool read_int(int & x) { return this->read(&x, sizeof(x)); }
+    bool read_str(std::string & str);
+
+    const char* data = NULL;
+    size_t size = 0;
+    size_t pos = 0;
+
+private:
+    bool mapped = false;
+    std::string buffer;              // contents, if not mapped
+};
+
+#endif
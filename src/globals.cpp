@@ -3,9 +3,18 @@
 #include "globals.h"
 #include "print.h"
 #include "timer.h"
+#include "fasta.h"
 
 void Globals::parse_args(int argc, char ** argv) {
 
+    /* 'vcfdist index' only writes the shared reference image, then exits */
+    if (argc > 1 && std::string(argv[1]) == "index") {
+        if (argc != 3) ERROR("Usage: vcfdist index <ref.fasta>");
+        this->ref_fasta_fn = std::string(argv[2]);
+        write_fasta_image(this->ref_fasta_fn);
+        std::exit(0);
+    }
+
     /* if required arguments are not provided, you can only print help and exit */
     bool print_cite = false;
     bool print_help = false;
@@ -95,7 +104,7 @@ void Globals::parse_args(int argc, char ** argv) {
         INFO("%s[0/8] Loading reference FASTA%s '%s'", COLOR_PURPLE,
                 COLOR_WHITE, ref_fasta_fn.data());
     }
-    this->ref_fasta_fp = fopen(ref_fasta_fn.data(), "r");
+    this->ref_fasta_fp = bgzf_open(ref_fasta_fn.data(), "r");
     if (ref_fasta_fp == NULL) {
         ERROR("Failed to open reference FASTA file '%s'", ref_fasta_fn.data());
     }
@@ -129,6 +138,19 @@ void Globals::parse_args(int argc, char ** argv) {
             } catch (const std::exception & e) {
                 ERROR("%s", e.what());
             }
+/*******************************************************************************/
+        } else if (std::string(argv[i]) == "--cache") {
+            i++;
+            if (i == argc) {
+                ERROR("Option '--cache' used without providing cache directory");
+            }
+            try {
+                this->cache_dir = std::string(argv[i++]);
+                std::filesystem::create_directories(this->cache_dir);
+                this->cache_exists = true;
+            } catch (const std::exception & e) {
+                ERROR("%s", e.what());
+            }
 /*******************************************************************************/
         } else if (std::string(argv[i]) == "-s" || 
                 std::string(argv[i]) == "--smallest-variant") {
@@ -475,6 +497,34 @@ void Globals::parse_args(int argc, char ** argv) {
             if (this->max_threads < 1) {
                 ERROR("Max threads must be positive");
             }
+/*******************************************************************************/
+        } else if (std::string(argv[i]) == "--io-threads") {
+            i++;
+            if (i == argc) {
+                ERROR("Option '--io-threads' used without providing I/O threads");
+            }
+            try {
+                this->io_threads = std::stoi(argv[i++]);
+            } catch (const std::exception & e) {
+                ERROR("Invalid I/O threads provided");
+            }
+            if (this->io_threads < 0) {
+                ERROR("I/O threads must be non-negative");
+            }
+/*******************************************************************************/
+        } else if (std::string(argv[i]) == "--contig-window") {
+            i++;
+            if (i == argc) {
+                ERROR("Option '--contig-window' used without providing number of contigs");
+            }
+            try {
+                this->contig_window = std::stoi(argv[i++]);
+            } catch (const std::exception & e) {
+                ERROR("Invalid contig window provided");
+            }
+            if (this->contig_window < 0) {
+                ERROR("Contig window must be non-negative");
+            }
 /*******************************************************************************/
         } else if (std::string(argv[i]) == "--max-ram") {
             i++;
@@ -545,6 +595,16 @@ void Globals::parse_args(int argc, char ** argv) {
         threads /= 2;
     }
 
+    // create shared thread pool for decompressing inputs
+    if (this->io_threads > 0) {
+        this->io_pool.pool = hts_tpool_init(this->io_threads);
+        if (this->io_pool.pool == NULL)
+            ERROR("Failed to create pool of %d I/O threads", this->io_threads);
+        if (bgzf_compression(this->ref_fasta_fp) == 2) // BGZF
+            bgzf_thread_pool(this->ref_fasta_fp, 
+                    this->io_pool.pool, this->io_pool.qsize);
+    }
+
     if (print_help) 
         this->print_usage();
     else if (print_cite)
@@ -561,18 +621,25 @@ void Globals::print_version() const
 void Globals::print_usage() const
 {
     printf("Usage: vcfdist <query.vcf> <truth.vcf> <ref.fasta> [options]\n"); 
+    printf("       vcfdist index <ref.fasta>\n"); 
 
     printf("\nRequired:\n");
     printf("  <STRING>\tquery.vcf\tphased VCF file containing variant calls to evaluate \n");
     printf("  <STRING>\ttruth.vcf\tphased VCF file containing ground truth variant calls \n");
     printf("  <STRING>\tref.fasta\tFASTA file containing draft reference sequence \n");
 
+    printf("\nIndex:\n");
+    printf("  'vcfdist index <ref.fasta>' writes '<ref.fasta>.vdr', a reference image\n");
+    printf("  that later runs map read-only, so concurrent runs share one copy in memory\n");
+
     printf("\nOptions:\n");
     printf("  -b, --bed <STRING>\n");
     printf("      BED file containing regions to evaluate\n\n");
 
     printf("  -p, --prefix <STRING> [./]\n");
-    printf("      prefix for output files (directory needs a trailing slash)\n\n");
+    printf("      prefix for output files (directory needs a trailing slash);\n");
+    printf("      multi-sample VCFs are evaluated per sample, matching truth samples\n");
+    printf("      by name, with outputs prefixed by '<prefix><sample>.'\n\n");
 
     printf("  -v, --verbosity <INTEGER> [%d]\n", g.verbosity);
     printf("      printing verbosity (0: succinct, 1: default, 2:verbose)\n\n");
@@ -617,6 +684,19 @@ void Globals::print_usage() const
     printf("      maximum threads to use for precision/recall alignment\n");
     printf("      (haps*contigs used for wavefront clustering)\n\n");
 
+    printf("  --io-threads <INTEGER> [%d]\n", g.io_threads);
+    printf("      additional threads for decompressing BGZF-compressed\n");
+    printf("      input VCFs and reference FASTA\n\n");
+
+    printf("  --contig-window <INTEGER> [%d]\n", g.contig_window);
+    printf("      evaluate and write this many contigs at a time, freeing each\n");
+    printf("      window before the next to reduce peak memory (0 = all at once);\n");
+    printf("      indexed VCFs are also parsed one window at a time\n\n");
+
+    printf("  --cache <STRING>\n");
+    printf("      directory for caching parsed, clustered and realigned VCFs,\n");
+    printf("      reused by later runs with the same inputs and parameters\n\n");
+
     printf("  --max-ram <FLOAT> [%.3fGB]\n", g.max_ram);
     printf("      maximum RAM to use for precision/recall alignment\n");
     printf("      (work in-progress, more may be used in other steps)\n\n");
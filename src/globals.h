@@ -3,6 +3,9 @@
 
 #include <filesystem>
 
+#include "htslib/bgzf.h"
+#include "htslib/thread_pool.h"
+
 #include "bed.h"
 #include "defs.h"
 #include "timer.h"
@@ -11,12 +14,14 @@ class Globals {
 public:
     // input files
     std::string ref_fasta_fn;
-    FILE* ref_fasta_fp;
+    BGZF* ref_fasta_fp;
     std::string query_vcf_fn;
     std::string truth_vcf_fn;
     std::string bed_fn;
     bedData bed;
     bool bed_exists = false;
+    std::string cache_dir;
+    bool cache_exists = false;
 
     // variant params
     int min_qual = 0;
@@ -38,6 +43,9 @@ public:
     int thread_nsteps;
     std::vector<int> thread_steps;
     std::vector<float> ram_steps;
+    int io_threads = 0;
+    htsThreadPool io_pool = {NULL, 0}; // shared BGZF decompression threads
+    int contig_window = 0;             // contigs evaluated at once, 0 = all
 
     // high-level options
     bool exit = false;
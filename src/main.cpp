@@ -1,4 +1,5 @@
 #include <thread>
+#include <algorithm>
 
 #include "variant.h"
 #include "print.h"
@@ -9,8 +10,10 @@
 #include "cluster.h"
 #include "phase.h"
 #include "timer.h"
+#include "cache.h"
 
 Globals g;
+contigDict ctg_dict;
 std::vector<std::string> type_strs = {"REF", "SNP", "INS", "DEL", "CPX"};
 std::vector<std::string> type_strs2 = {"ALL", "SNP", "INS", "DEL", "INDEL"};
 std::vector<std::string> vartype_strs = {"SNP", "INDEL"};
@@ -30,171 +33,280 @@ int main(int argc, char **argv) {
     g.parse_args(argc, argv);
     g.init_timers(timer_strs);
 
-    // parse reference fasta
+    // parse reference fasta, query VCF, and truth VCF concurrently
 g.timers[TIME_TOTAL].start();
 g.timers[TIME_READ].start();
-    std::shared_ptr<fastaData> ref_ptr(new fastaData(g.ref_fasta_fp));
+    std::shared_ptr<fastaData> ref_ptr;
+    std::vector< std::shared_ptr<variantData> > query_vcfs;
+    std::vector< std::shared_ptr<variantData> > truth_vcfs;
+    std::vector<std::string> query_cache_fns, truth_cache_fns;
+    bool query_cached = false, truth_cached = false;
+    std::thread ref_thread([&ref_ptr]() {
+        ref_ptr = std::shared_ptr<fastaData>(new fastaData(g.ref_fasta_fn, g.ref_fasta_fp));
+    });
+    std::thread query_thread([&]() {
+        if (g.cache_exists) { // load preprocessed VCF samples if available
+            query_cache_fns = cache_filenames(QUERY, 
+                    read_vcf_samples(g.query_vcf_fn, QUERY));
+            query_vcfs = load_caches(query_cache_fns, QUERY);
+            query_cached = !query_vcfs.empty();
+        }
+        if (!query_cached) query_vcfs = read_vcf(g.query_vcf_fn, nullptr, QUERY);
+    });
+    std::thread truth_thread([&]() {
+        if (g.cache_exists) {
+            truth_cache_fns = cache_filenames(TRUTH, 
+                    read_vcf_samples(g.truth_vcf_fn, TRUTH));
+            truth_vcfs = load_caches(truth_cache_fns, TRUTH);
+            truth_cached = !truth_vcfs.empty();
+        }
+        if (!truth_cached) truth_vcfs = read_vcf(g.truth_vcf_fn, nullptr, TRUTH);
+    });
+    ref_thread.join();
+    query_thread.join();
+    truth_thread.join();
+    bool deferred = query_vcfs[0]->deferred || truth_vcfs[0]->deferred;
+    if (g.io_pool.pool != NULL && !deferred) { // all inputs closed
+        hts_tpool_destroy(g.io_pool.pool);
+        g.io_pool.pool = NULL;
+    }
 
-    // parse query and truth VCFs
-    std::shared_ptr<variantData> query_ptr(
-            new variantData(g.query_vcf_fn, ref_ptr, QUERY));
-    std::shared_ptr<variantData> truth_ptr(
-            new variantData(g.truth_vcf_fn, ref_ptr, TRUTH));
+    // pair each query sample with the truth sample of the same name
+    std::vector<int> truth_idxs;
+    if (query_vcfs.size() == 1 && truth_vcfs.size() == 1) {
+        truth_idxs.push_back(0);
+    } else {
+        for (auto & query_vcf : query_vcfs) {
+            int truth_idx = 0;
+            while (truth_idx < int(truth_vcfs.size()) && 
+                    truth_vcfs[truth_idx]->sample != query_vcf->sample) truth_idx++;
+            if (truth_idx == int(truth_vcfs.size()))
+                ERROR("Query sample '%s' not found in truth VCF '%s'", 
+                        query_vcf->sample.data(), g.truth_vcf_fn.data());
+            truth_idxs.push_back(truth_idx);
+        }
+        for (auto & truth_vcf : truth_vcfs) {
+            if (std::none_of(query_vcfs.begin(), query_vcfs.end(), 
+                        [&](const std::shared_ptr<variantData> & query_vcf) { 
+                        return query_vcf->sample == truth_vcf->sample; }))
+                WARN("Truth sample '%s' not found in query VCF '%s', skipping", 
+                        truth_vcf->sample.data(), g.query_vcf_fn.data());
+        }
+    }
 g.timers[TIME_READ].stop();
+
+    // evaluate each sample in turn, sharing the reference
+    std::string out_prefix = g.out_prefix;
+    for (int smp = 0; smp < int(query_vcfs.size()); smp++) {
+        std::shared_ptr<variantData> query_vcf = query_vcfs[smp];
+        std::shared_ptr<variantData> truth_vcf = truth_vcfs[truth_idxs[smp]];
+        query_vcf->ref = ref_ptr;
+        truth_vcf->ref = ref_ptr;
+        if (query_vcfs.size() > 1) {
+            g.out_prefix = out_prefix + query_vcf->sample + ".";
+            if (g.verbosity >= 1) INFO(" ");
+            if (g.verbosity >= 1) INFO("%sEvaluating sample '%s'%s", COLOR_PURPLE,
+                    query_vcf->sample.data(), COLOR_WHITE);
+        }
+
 g.timers[TIME_WRITE].start();
-    query_ptr->write_vcf(g.out_prefix + "orig-query.vcf");
-    truth_ptr->write_vcf(g.out_prefix + "orig-truth.vcf");
+        if (query_cached) 
+            write_cached_vcf(query_cache_fns[smp], g.out_prefix + "orig-query.vcf");
+        else query_vcf->write_vcf(g.out_prefix + "orig-query.vcf");
+        if (truth_cached) 
+            write_cached_vcf(truth_cache_fns[truth_idxs[smp]], g.out_prefix + "orig-truth.vcf");
+        else truth_vcf->write_vcf(g.out_prefix + "orig-truth.vcf");
 g.timers[TIME_WRITE].stop();
 
-    // ensure each input contains all contigs in BED
-    check_contigs(query_ptr, truth_ptr, ref_ptr);
+        // ensure each input contains all contigs in BED
+        check_contigs(query_vcf, truth_vcf, ref_ptr);
 
-    // cluster, realign, and cluster query VCF
-    if (!g.keep_query) {
+        // evaluate a window of contigs at a time (all at once by default),
+        // writing and freeing each window's results before the next
+        std::vector<int> ctgs = query_vcf->contigs;
+        int window = g.contig_window ? g.contig_window : std::max(int(ctgs.size()), 1);
+        int nwindows = std::max(int(ctgs.size() + window-1) / window, 1);
+        bool windowed = nwindows > 1 || query_vcf->deferred || truth_vcf->deferred;
+        if (g.cache_exists && windowed && !(query_cached && truth_cached))
+            WARN("VCFs are not cached when evaluating contig windows");
+        resultsWriter writer(query_vcf, truth_vcf);
+        for (int w = 0; w < nwindows; w++) {
+            std::vector<int> window_ctgs(ctgs.begin() + std::min(w*window, int(ctgs.size())),
+                    ctgs.begin() + std::min((w+1)*window, int(ctgs.size())));
+            if (nwindows > 1) {
+                if (g.verbosity >= 1) INFO(" ");
+                if (g.verbosity >= 1) INFO("%sEvaluating contigs %d-%d of %d%s", 
+                        COLOR_PURPLE, w*window+1, w*window + int(window_ctgs.size()),
+                        int(ctgs.size()), COLOR_WHITE);
+            }
+
+            // parse deferred variants of indexed VCFs (see read_vcf())
+g.timers[TIME_READ].start();
+            std::shared_ptr<variantData> query_ptr = query_vcf->deferred ?
+                read_vcf_window(query_vcf, window_ctgs) : query_vcf->take_contigs(window_ctgs);
+            std::shared_ptr<variantData> truth_ptr = truth_vcf->deferred ?
+                read_vcf_window(truth_vcf, window_ctgs) : truth_vcf->take_contigs(window_ctgs);
+g.timers[TIME_READ].stop();
+g.timers[TIME_WRITE].start();
+            if (query_vcf->deferred) query_ptr->append_vcf(g.out_prefix + "orig-query.vcf");
+            if (truth_vcf->deferred) truth_ptr->append_vcf(g.out_prefix + "orig-truth.vcf");
+g.timers[TIME_WRITE].stop();
+
+            // cluster, realign, and cluster query VCF
+            if (!g.keep_query && !query_cached) {
 g.timers[TIME_CLUST].start();
-        if (g.simple_cluster) {
-            gap_cluster(query_ptr, QUERY);
-        } else {
-            if (g.verbosity >= 1) INFO(" ");
-            if (g.verbosity >= 1) INFO("%s[Q 1/8] Wavefront clustering %s VCF%s '%s'", 
-                    COLOR_PURPLE, callset_strs[QUERY].data(), 
-                    COLOR_WHITE, query_ptr->filename.data());
-            std::vector<std::thread> threads;
-            for (int t = 0; t < HAPS*int(query_ptr->contigs.size()); t++)
-                threads.push_back(std::thread( wf_swg_cluster, 
-                            query_ptr.get(), query_ptr->contigs[t/2], t%2, /* hap */
-                            g.query_sub, g.query_open, g.query_extend)); 
-            for (auto & t : threads)
-                t.join();
-        }
+                if (g.simple_cluster) {
+                    gap_cluster(query_ptr, QUERY);
+                } else {
+                    if (g.verbosity >= 1) INFO(" ");
+                    if (g.verbosity >= 1) INFO("%s[Q 1/8] Wavefront clustering %s VCF%s '%s'", 
+                            COLOR_PURPLE, callset_strs[QUERY].data(), 
+                            COLOR_WHITE, query_ptr->filename.data());
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t < HAPS*int(query_ptr->contigs.size()); t++)
+                        threads.push_back(std::thread( wf_swg_cluster, 
+                                    query_ptr.get(), query_ptr->contigs[t/2], t%2, /* hap */
+                                    g.query_sub, g.query_open, g.query_extend)); 
+                    for (auto & t : threads)
+                        t.join();
+                }
 g.timers[TIME_CLUST].stop();
 
 g.timers[TIME_REALN].start();
-        query_ptr = wf_swg_realign(query_ptr, ref_ptr, 
-                g.query_sub, g.query_open, g.query_extend, QUERY);
-        query_ptr->left_shift();
+                query_ptr = wf_swg_realign(query_ptr, ref_ptr, 
+                        g.query_sub, g.query_open, g.query_extend, QUERY);
+                query_ptr->left_shift();
 g.timers[TIME_REALN].stop();
-    }
+            }
 
-    if (g.exit) { // realign only, exit early
-g.timers[TIME_WRITE].start();
-        query_ptr->write_vcf(g.out_prefix + "query.vcf");
-g.timers[TIME_WRITE].stop();
-
-    } else { // re-cluster based on new alignments
+            if (!g.exit && !query_cached) { // re-cluster based on new alignments
 g.timers[TIME_RECLUST].start();
-        if (g.simple_cluster) {
-            gap_cluster(query_ptr, QUERY);
-        } else {
-            if (g.verbosity >= 1) INFO(" ");
-            if (g.verbosity >= 1) INFO("%s[Q 3/8] Wavefront reclustering %s VCF%s '%s'", 
-                    COLOR_PURPLE, callset_strs[QUERY].data(), 
-                    COLOR_WHITE, query_ptr->filename.data());
-            std::vector<std::thread> threads;
-            for (int t = 0; t < HAPS*int(query_ptr->contigs.size()); t++)
-                threads.push_back(std::thread( wf_swg_cluster, 
-                            query_ptr.get(), query_ptr->contigs[t/2], t%2, /* hap */
-                            g.query_sub, g.query_open, g.query_extend)); 
-            for (auto & t : threads)
-                t.join();
-        }
+                if (g.simple_cluster) {
+                    gap_cluster(query_ptr, QUERY);
+                } else {
+                    if (g.verbosity >= 1) INFO(" ");
+                    if (g.verbosity >= 1) INFO("%s[Q 3/8] Wavefront reclustering %s VCF%s '%s'", 
+                            COLOR_PURPLE, callset_strs[QUERY].data(), 
+                            COLOR_WHITE, query_ptr->filename.data());
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t < HAPS*int(query_ptr->contigs.size()); t++)
+                        threads.push_back(std::thread( wf_swg_cluster, 
+                                    query_ptr.get(), query_ptr->contigs[t/2], t%2, /* hap */
+                                    g.query_sub, g.query_open, g.query_extend)); 
+                    for (auto & t : threads)
+                        t.join();
+                }
 g.timers[TIME_RECLUST].stop();
-    }
+                if (g.cache_exists && !windowed) 
+                    save_cache(query_cache_fns[smp], query_ptr, 
+                            g.out_prefix + "orig-query.vcf");
+            }
 
-    // cluster, realign, and cluster truth VCF
-    if (!g.keep_truth) {
+            // cluster, realign, and cluster truth VCF
+            if (!g.keep_truth && !truth_cached) {
 g.timers[TIME_CLUST].start();
-        if (g.simple_cluster) {
-            gap_cluster(truth_ptr, TRUTH);
-        } else {
-            if (g.verbosity >= 1) INFO(" ");
-            if (g.verbosity >= 1) INFO("%s[T 1/8] Wavefront clustering %s VCF%s '%s'", 
-                    COLOR_PURPLE, callset_strs[TRUTH].data(), 
-                    COLOR_WHITE, truth_ptr->filename.data());
-            std::vector<std::thread> threads;
-            for (int t = 0; t < HAPS*int(truth_ptr->contigs.size()); t++)
-                threads.push_back(std::thread( wf_swg_cluster, 
-                            truth_ptr.get(), truth_ptr->contigs[t/2], t%2, /* hap */
-                            g.truth_sub, g.truth_open, g.truth_extend)); 
-            for (auto & t : threads)
-                t.join();
-        }
+                if (g.simple_cluster) {
+                    gap_cluster(truth_ptr, TRUTH);
+                } else {
+                    if (g.verbosity >= 1) INFO(" ");
+                    if (g.verbosity >= 1) INFO("%s[T 1/8] Wavefront clustering %s VCF%s '%s'", 
+                            COLOR_PURPLE, callset_strs[TRUTH].data(), 
+                            COLOR_WHITE, truth_ptr->filename.data());
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t < HAPS*int(truth_ptr->contigs.size()); t++)
+                        threads.push_back(std::thread( wf_swg_cluster, 
+                                    truth_ptr.get(), truth_ptr->contigs[t/2], t%2, /* hap */
+                                    g.truth_sub, g.truth_open, g.truth_extend)); 
+                    for (auto & t : threads)
+                        t.join();
+                }
 g.timers[TIME_CLUST].stop();
 
 g.timers[TIME_REALN].start();
-        truth_ptr = wf_swg_realign(truth_ptr, ref_ptr, 
-                g.truth_sub, g.truth_open, g.truth_extend, TRUTH);
-        truth_ptr->left_shift();
+                truth_ptr = wf_swg_realign(truth_ptr, ref_ptr, 
+                        g.truth_sub, g.truth_open, g.truth_extend, TRUTH);
+                truth_ptr->left_shift();
 g.timers[TIME_REALN].stop();
-    }
+            }
 
-    if (g.exit) { // realign only, exit early
+            if (g.exit) { // realign only, exit early
 g.timers[TIME_WRITE].start();
-        truth_ptr->write_vcf(g.out_prefix + "truth.vcf");
+                writer.write_vcfs(query_ptr, truth_ptr);
 g.timers[TIME_WRITE].stop();
-g.timers[TIME_TOTAL].stop();
-        if (g.verbosity >= 1) {
-            INFO(" ")
-            INFO("Timers:")
-            for (int i = 0; i < TIME_TOTAL+1; i++) { g.timers[i].print(i); }
-        }
-        return EXIT_SUCCESS;
+                continue;
 
-    } else {
+            } else if (!truth_cached) {
 
 g.timers[TIME_RECLUST].start();
-        if (g.simple_cluster) {
-            gap_cluster(truth_ptr, TRUTH); 
-        } else {
-            if (g.verbosity >= 1) INFO(" ");
-            if (g.verbosity >= 1) INFO("%s[T 3/8] Wavefront reclustering %s VCF%s '%s'", 
-                    COLOR_PURPLE, callset_strs[TRUTH].data(), 
-                    COLOR_WHITE, truth_ptr->filename.data());
-            std::vector<std::thread> threads;
-            for (int t = 0; t < HAPS*int(truth_ptr->contigs.size()); t++)
-                threads.push_back(std::thread( wf_swg_cluster, 
-                            truth_ptr.get(), truth_ptr->contigs[t/2], t%2, /* hap */
-                            g.truth_sub, g.truth_open, g.truth_extend)); 
-            for (auto & t : threads)
-                t.join();
-        }
+                if (g.simple_cluster) {
+                    gap_cluster(truth_ptr, TRUTH); 
+                } else {
+                    if (g.verbosity >= 1) INFO(" ");
+                    if (g.verbosity >= 1) INFO("%s[T 3/8] Wavefront reclustering %s VCF%s '%s'", 
+                            COLOR_PURPLE, callset_strs[TRUTH].data(), 
+                            COLOR_WHITE, truth_ptr->filename.data());
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t < HAPS*int(truth_ptr->contigs.size()); t++)
+                        threads.push_back(std::thread( wf_swg_cluster, 
+                                    truth_ptr.get(), truth_ptr->contigs[t/2], t%2, /* hap */
+                                    g.truth_sub, g.truth_open, g.truth_extend)); 
+                    for (auto & t : threads)
+                        t.join();
+                }
 g.timers[TIME_RECLUST].stop();
-    }
+                if (g.cache_exists && !windowed) 
+                    save_cache(truth_cache_fns[truth_idxs[smp]], truth_ptr, 
+                            g.out_prefix + "orig-truth.vcf");
+            }
 
-    // calculate superclusters
+            // calculate superclusters
 g.timers[TIME_SUPCLUST].start();
-    std::shared_ptr<superclusterData> clusterdata_ptr(
-            new superclusterData(query_ptr, truth_ptr, ref_ptr));
+            std::shared_ptr<superclusterData> clusterdata_ptr(
+                    new superclusterData(query_ptr, truth_ptr, ref_ptr));
 g.timers[TIME_SUPCLUST].stop();
 
-    // calculate supercluster sizes
-    auto sc_groups = sort_superclusters(clusterdata_ptr);
+            // calculate supercluster sizes
+            auto sc_groups = sort_superclusters(clusterdata_ptr);
 
-    // calculate precision/recall and local phasing
+            // calculate precision/recall and local phasing
 g.timers[TIME_PR_ALN].start();
-    precision_recall_threads_wrapper(clusterdata_ptr, sc_groups);
+            precision_recall_threads_wrapper(clusterdata_ptr, sc_groups);
 g.timers[TIME_PR_ALN].stop();
 
-    // calculate edit distance
+            // calculate edit distance
 g.timers[TIME_EDITS].start();
-    editData edits = edits_wrapper(clusterdata_ptr);
+            editData edits = edits_wrapper(clusterdata_ptr);
 g.timers[TIME_EDITS].stop();
 
-    // calculate global phasings
+            // calculate global phasings
 g.timers[TIME_PHASE].start();
-    std::unique_ptr<phaseData> phasedata_ptr(new phaseData(clusterdata_ptr));
+            std::unique_ptr<phaseData> phasedata_ptr(new phaseData(clusterdata_ptr));
 g.timers[TIME_PHASE].stop();
 
-    // write supercluster/phaseblock results in CSV format
+            // append this window's results and realigned VCFs
 g.timers[TIME_WRITE].start();
-    write_results(phasedata_ptr, edits);
+            writer.write_results(phasedata_ptr, edits);
+            writer.write_vcfs(query_ptr, truth_ptr);
+g.timers[TIME_WRITE].stop();
 
-    // save new VCF
-    query_ptr->write_vcf(g.out_prefix + "query.vcf");
-    truth_ptr->write_vcf(g.out_prefix + "truth.vcf");
-    phasedata_ptr->write_summary_vcf(g.out_prefix + "summary.vcf");
+            // reference is still needed if other samples remain
+            if (query_vcfs.size() == 1)
+                for (int ctg : window_ctgs) ref_ptr->erase(ctg);
+        }
+g.timers[TIME_WRITE].start();
+        writer.close();
 g.timers[TIME_WRITE].stop();
 
+        // release this sample's variants before evaluating the next
+        query_vcfs[smp] = nullptr;
+        truth_vcfs[truth_idxs[smp]] = nullptr;
+    }
+    g.out_prefix = out_prefix;
+    if (g.io_pool.pool != NULL) { // deferred inputs closed
+        hts_tpool_destroy(g.io_pool.pool);
+        g.io_pool.pool = NULL;
+    }
+
     // report timing results
 g.timers[TIME_TOTAL].stop();
     if (g.verbosity >= 1) {
@@ -5,11 +5,11 @@
 #include "print.h"
 #include "globals.h"
 
-void phaseData::write_summary_vcf(std::string out_vcf_fn) {
-
-    // VCF header
-    if (g.verbosity >= 1) INFO("  Printing GA4GH-compatible summary VCF to '%s'", out_vcf_fn.data());
-    FILE* out_vcf = fopen(out_vcf_fn.data(), "w");
+/* Write the summary VCF header, listing contigs `ctgs` (and their lengths and
+ * ploidy). Records are appended separately by `phaseData::write_summary_vcf`.
+ */
+void write_summary_vcf_header(FILE* out_vcf, const std::vector<int> & ctgs,
+        const std::vector<int> & lengths, const std::vector<int> & ploidy) {
     const std::chrono::time_point now{std::chrono::system_clock::now()};
     time_t tt = std::chrono::system_clock::to_time_t(now);
     tm local_time = *localtime(&tt);
@@ -17,9 +17,9 @@ void phaseData::write_summary_vcf(std::string out_vcf_fn) {
     fprintf(out_vcf, "##fileDate=%04d%02d%02d\n", local_time.tm_year + 1900, 
             local_time.tm_mon + 1, local_time.tm_mday);
     fprintf(out_vcf, "##CL=%s\n", g.cmd.data()+1);
-    for (size_t i = 0; i < this->contigs.size(); i++) {
+    for (size_t i = 0; i < ctgs.size(); i++) {
         fprintf(out_vcf, "##contig=<ID=%s,length=%d,ploidy=%d>\n", 
-                this->contigs[i].data(), this->lengths[i], this->ploidy[i]);
+                ctg_dict.name(ctgs[i]).data(), lengths[i], ploidy[i]);
     }
     fprintf(out_vcf, "##FILTER=<ID=PASS,Description=\"All filters passed\">\n");
     fprintf(out_vcf, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"GenoType\">\n");
@@ -30,9 +30,11 @@ void phaseData::write_summary_vcf(std::string out_vcf_fn) {
     fprintf(out_vcf, "##FORMAT=<ID=SC,Number=1,Type=Integer,Description=\"SuperCluster index\">\n");
     fprintf(out_vcf, "##FORMAT=<ID=SP,Number=1,Type=Integer,Description=\"Swapped Phase (from original) for query variant (0=NO,1=YES)\">\n");
     fprintf(out_vcf, "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tTRUTH\tQUERY\n");
+}
+
 
-    // write variants
-    for (std::string ctg : this->contigs) {
+void phaseData::write_summary_vcf(FILE* out_vcf) {
+    for (int ctg : this->contigs) {
         std::vector< std::vector<int> > ptrs = std::vector< std::vector<int> >(
                 CALLSETS, std::vector<int>(HAPS, 0));
         std::vector< std::vector<int> > poss = std::vector< std::vector<int> >(
@@ -90,20 +92,20 @@ void phaseData::write_summary_vcf(std::string out_vcf_fn) {
             std::vector<bool> homo = {false, false};
             for (int c = 0; c < CALLSETS; c++) {
                 homo[c] = next[c][HAP1] && next[c][HAP2] &&
-                        vars[c][HAP1]->refs[ptrs[c][HAP1]] == 
-                        vars[c][HAP2]->refs[ptrs[c][HAP2]] &&
-                        vars[c][HAP1]->alts[ptrs[c][HAP1]] == 
-                        vars[c][HAP2]->alts[ptrs[c][HAP2]];
+                        vars[c][HAP1]->ref(ptrs[c][HAP1]) == 
+                        vars[c][HAP2]->ref(ptrs[c][HAP2]) &&
+                        vars[c][HAP1]->alt(ptrs[c][HAP1]) == 
+                        vars[c][HAP2]->alt(ptrs[c][HAP2]);
             }
 
             // store if query and truth contain same variant
             std::vector<bool> pair = {false, false};
             for (int h = 0; h < HAPS; h++) {
                 pair[h] = next[QUERY][h] && next[TRUTH][swap^h] &&
-                        vars[QUERY][h]->refs[ptrs[QUERY][h]] == 
-                        vars[TRUTH][swap^h]->refs[ptrs[TRUTH][swap^h]] &&
-                        vars[QUERY][h]->alts[ptrs[QUERY][h]] == 
-                        vars[TRUTH][swap^h]->alts[ptrs[TRUTH][swap^h]];
+                        vars[QUERY][h]->ref(ptrs[QUERY][h]) == 
+                        vars[TRUTH][swap^h]->ref(ptrs[TRUTH][swap^h]) &&
+                        vars[QUERY][h]->alt(ptrs[QUERY][h]) == 
+                        vars[TRUTH][swap^h]->alt(ptrs[TRUTH][swap^h]);
             }
 
             if (next[QUERY][HAP1]) {
@@ -193,7 +195,6 @@ void phaseData::write_summary_vcf(std::string out_vcf_fn) {
             }
         }
     }
-    fclose(out_vcf);
 }
 
 
@@ -203,8 +204,9 @@ void phaseData::write_summary_vcf(std::string out_vcf_fn) {
 phaseData::phaseData(std::shared_ptr<superclusterData> clusterdata_ptr)
 {
     // copy contigs and reference
+    this->ctg_phasings.resize(ctg_dict.size(), nullptr);
     for (int i = 0; i < int(clusterdata_ptr->contigs.size()); i++) {
-        std::string ctg = clusterdata_ptr->contigs[i];
+        int ctg = clusterdata_ptr->contigs[i];
         this->contigs.push_back(ctg);
         this->lengths.push_back(clusterdata_ptr->lengths[i]);
         this->ploidy.push_back(clusterdata_ptr->ploidy[i]);
@@ -316,7 +318,8 @@ void phaseData::phase()
         }
 
         if (false) {
-            printf("  Contig '%s' phase block cluster indices: ", ctg.data());
+            printf("  Contig '%s' phase block cluster indices: ", 
+                    ctg_dict.name(ctg).data());
             for(int i = 0; i < this->ctg_phasings[ctg]->nswitches; i++)
                 printf("%d ", this->ctg_phasings[ctg]->phase_blocks[i]);
             printf("\n");
@@ -24,14 +24,17 @@ public:
     phaseData(std::shared_ptr<superclusterData> clusterdata_ptr); 
 
     void phase();
-    void write_summary_vcf(std::string vcf_fn);
+    void write_summary_vcf(FILE* out_fp);
 
     std::shared_ptr<fastaData> ref;
-    std::vector<std::string> contigs;
+    std::vector<int> contigs;        // contig IDs
     std::vector<int> lengths;
     std::vector<int> ploidy;
-    std::unordered_map<std::string, 
+    std::vector< // indexed by contig ID
         std::shared_ptr<ctgPhasings> > ctg_phasings;
 };
 
+void write_summary_vcf_header(FILE* out_fp, const std::vector<int> & ctgs,
+        const std::vector<int> & lengths, const std::vector<int> & ploidy);
+
 #endif
@@ -286,16 +286,68 @@ void print_ptrs(const std::vector< std::vector<uint8_t> > & ptrs,
 /*******************************************************************************/
 
 
-void write_precision_recall(std::unique_ptr<phaseData> & phasedata_ptr) {
+resultsWriter::resultsWriter(
+        std::shared_ptr<variantData> query_ptr,
+        std::shared_ptr<variantData> truth_ptr) {
+
+    // realigned VCFs are always written, even when exiting early
+    this->out_query_vcf = fopen((g.out_prefix + "query.vcf").data(), "w");
+    this->out_truth_vcf = fopen((g.out_prefix + "truth.vcf").data(), "w");
+    query_ptr->write_vcf_header(this->out_query_vcf);
+    truth_ptr->write_vcf_header(this->out_truth_vcf);
+    if (g.exit) return;
 
     // init counters; ax0: SUB/INDEL, ax1: TP,FP,FN,PP,PP_FRAC, ax2: QUAL
+    this->query_counts.assign(VARTYPES, std::vector< std::vector<float> >(5,
+            std::vector<float>(g.max_qual-g.min_qual+1, 0.0)));
+    this->truth_counts.assign(VARTYPES, std::vector< std::vector<float> >(5,
+            std::vector<float>(g.max_qual-g.min_qual+1, 0.0)));
+    this->edit_dists.assign(g.max_qual-g.min_qual+2, std::vector<int>(TYPES, 0));
+    this->distinct_edits.assign(g.max_qual-g.min_qual+2, std::vector<int>(TYPES, 0));
+    this->scores.assign(g.max_qual-g.min_qual+2, 0);
+
+    // superclusters are formed from query contigs, then truth-only contigs
+    this->out_summary_vcf = fopen((g.out_prefix + "summary.vcf").data(), "w");
+    write_summary_vcf_header(this->out_summary_vcf, 
+            query_ptr->contigs, query_ptr->lengths, query_ptr->ploidy);
+
+    this->out_edits = fopen((g.out_prefix + "edits.tsv").data(), "w");
+    fprintf(this->out_edits, "CONTIG\tSTART\tHAP\tTYPE\tSIZE\tSUPERCLUSTER\tQUAL\n");
+
+    this->out_phasings = fopen((g.out_prefix + "phase-blocks.tsv").data(), "w");
+    fprintf(this->out_phasings, "CONTIG\tSTART\tSTOP\tSIZE\tSUPERCLUSTERS\n");
+
+    this->out_clusterings = fopen((g.out_prefix + "superclusters.tsv").data(), "w");
+    fprintf(this->out_clusterings, "CONTIG\tSTART\tSTOP\tSIZE\tQUERY1_VARS\tQUERY2_VARS"
+            "\tTRUTH1_VARS\tTRUTH2_VARS\tORIG_ED\tSWAP_ED\tPHASE\tPHASE_BLOCK\n");
+
+    this->out_query = fopen((g.out_prefix + "query.tsv").data(), "w");
+    fprintf(this->out_query, "CONTIG\tPOS\tHAP\tREF\tALT\tQUAL\tTYPE\tERR_TYPE"
+            "\tCREDIT\tCLUSTER\tSUPERCLUSTER\tLOCATION\n");
+
+    this->out_truth = fopen((g.out_prefix + "truth.tsv").data(), "w");
+    fprintf(this->out_truth, "CONTIG\tPOS\tHAP\tREF\tALT\tQUAL\tTYPE\tERRTYPE\tCREDIT\tCLUSTER\tSUPERCLUSTER\tLOCATION\n");
+}
+
+
+/*******************************************************************************/
+
+
+void resultsWriter::write_vcfs(
+        std::shared_ptr<variantData> query_ptr,
+        std::shared_ptr<variantData> truth_ptr) {
+    query_ptr->write_vcf_records(this->out_query_vcf);
+    truth_ptr->write_vcf_records(this->out_truth_vcf);
+}
+
+
+/*******************************************************************************/
+
+
+void resultsWriter::add_precision_recall(std::unique_ptr<phaseData> & phasedata_ptr) {
     int PP_FRAC = 4;
-    std::vector< std::vector< std::vector<float> > > query_counts(VARTYPES,
-            std::vector< std::vector<float> >(5, 
-            std::vector<float>(g.max_qual-g.min_qual+1, 0.0))) ;
-    std::vector< std::vector< std::vector<float> > > truth_counts(VARTYPES,
-            std::vector< std::vector<float> >(5, 
-            std::vector<float>(g.max_qual-g.min_qual+1, 0.0))) ;
+    auto & query_counts = this->query_counts;
+    auto & truth_counts = this->truth_counts;
 
     // calculate summary statistics
     for (auto ctg : phasedata_ptr->contigs) {
@@ -313,11 +365,11 @@ void write_precision_recall(std::unique_ptr<phaseData> & phasedata_ptr) {
                         vars[QUERY][h]->types[i] == TYPE_DEL) {
                     t = VARTYPE_INDEL;
                 } else {
-                    ERROR("Unexpected variant type (%d) in write_precision_recall()", 
+                    ERROR("Unexpected variant type (%d) in add_precision_recall()", 
                             vars[QUERY][h]->types[i]);
                 }
                 if (vars[QUERY][h]->errtypes[i] == ERRTYPE_UN) {
-                    WARN("Unknown error type at QUERY %s:%d", ctg.data(), vars[QUERY][h]->poss[i]);
+                    WARN("Unknown error type at QUERY %s:%d", ctg_dict.name(ctg).data(), vars[QUERY][h]->poss[i]);
                     continue;
                 }
                 for (int qual = g.min_qual; qual <= q; qual++) {
@@ -340,11 +392,11 @@ void write_precision_recall(std::unique_ptr<phaseData> & phasedata_ptr) {
                         vars[TRUTH][h]->types[i] == TYPE_DEL) {
                     t = VARTYPE_INDEL;
                 } else {
-                    ERROR("Unexpected variant type (%d) in write_precision_recall()", 
+                    ERROR("Unexpected variant type (%d) in add_precision_recall()", 
                             vars[TRUTH][h]->types[i]);
                 }
                 if (vars[TRUTH][h]->errtypes[i] == ERRTYPE_UN) {
-                    WARN("Unknown error type at TRUTH %s:%d", ctg.data(), vars[TRUTH][h]->poss[i]);
+                    WARN("Unknown error type at TRUTH %s:%d", ctg_dict.name(ctg).data(), vars[TRUTH][h]->poss[i]);
                     continue;
                 }
                 for (int qual = g.min_qual; qual <= q; qual++) {
@@ -356,6 +408,13 @@ void write_precision_recall(std::unique_ptr<phaseData> & phasedata_ptr) {
             }
         }
     }
+}
+
+
+void resultsWriter::write_precision_recall() {
+    int PP_FRAC = 4;
+    const auto & query_counts = this->query_counts;
+    const auto & truth_counts = this->truth_counts;
 
     // write results
     std::string out_pr_fn = g.out_prefix + "precision-recall.tsv";
@@ -498,7 +557,18 @@ void write_precision_recall(std::unique_ptr<phaseData> & phasedata_ptr) {
 /*******************************************************************************/
 
 
-void write_distance(const editData & edits) {
+void resultsWriter::add_distance(const editData & edits) {
+    for (int q = g.min_qual; q <= g.max_qual+1; q++) {
+        for (int type = 0; type < TYPES; type++) {
+            this->edit_dists[q-g.min_qual][type] += edits.get_ed(q, type);
+            this->distinct_edits[q-g.min_qual][type] += edits.get_de(q, type);
+        }
+        this->scores[q-g.min_qual] += edits.get_score(q);
+    }
+}
+
+
+void resultsWriter::write_distance() {
 
     // log all distance results
     std::string dist_fn = g.out_prefix + "distance.tsv";
@@ -510,10 +580,10 @@ void write_distance(const editData & edits) {
     // get original scores / distance (above g.max_qual, no vars applied)
     std::vector<int> orig_edit_dists(TYPES, 0);
     std::vector<int> orig_distinct_edits(TYPES, 0);
-    int orig_score = edits.get_score(g.max_qual+1);
+    int orig_score = this->scores[g.max_qual+1-g.min_qual];
     for (int type = 0; type < TYPES; type++) {
-        orig_edit_dists[type] = edits.get_ed(g.max_qual+1, type);
-        orig_distinct_edits[type] = edits.get_de(g.max_qual+1, type);
+        orig_edit_dists[type] = this->edit_dists[g.max_qual+1-g.min_qual][type];
+        orig_distinct_edits[type] = this->distinct_edits[g.max_qual+1-g.min_qual][type];
     }
 
     std::vector<double> best_score(TYPES, std::numeric_limits<double>::max());
@@ -524,8 +594,8 @@ void write_distance(const editData & edits) {
         std::vector<int> edit_dists(TYPES, 0);
         std::vector<int> distinct_edits(TYPES, 0);
         for (int type = 0; type < TYPES; type++) {
-            edit_dists[type] = edits.get_ed(q, type);
-            distinct_edits[type] = edits.get_de(q, type);
+            edit_dists[type] = this->edit_dists[q-g.min_qual][type];
+            distinct_edits[type] = this->distinct_edits[q-g.min_qual][type];
 
             // save best Q threshold so far
             double score = double(edit_dists[type]) * distinct_edits[type];
@@ -540,7 +610,7 @@ void write_distance(const editData & edits) {
                 distinct_edits[TYPE_INS], distinct_edits[TYPE_DEL],
                 edit_dists[TYPE_SUB], edit_dists[TYPE_INS], edit_dists[TYPE_DEL],
                 distinct_edits[TYPE_ALL], edit_dists[TYPE_ALL],
-                edits.get_score(q), qscore(double(edits.get_score(q))/orig_score));
+                this->scores[q-g.min_qual], qscore(double(this->scores[q-g.min_qual])/orig_score));
     }
     fclose(out_dists);
 
@@ -572,13 +642,13 @@ void write_distance(const editData & edits) {
             std::vector<int> edit_dists(TYPES, 0);
             std::vector<int> distinct_edits(TYPES, 0);
             for (int type = 0; type < TYPES; type++) {
-                edit_dists[type] = edits.get_ed(q, type);
-                distinct_edits[type] = edits.get_de(q, type);
+                edit_dists[type] = this->edit_dists[q-g.min_qual][type];
+                distinct_edits[type] = this->distinct_edits[q-g.min_qual][type];
             }
 
             float ed_qscore = qscore(double(edit_dists[type]) / orig_edit_dists[type]);
             float de_qscore = qscore(double(distinct_edits[type]) / orig_distinct_edits[type]);
-            float all_qscore = type == TYPE_ALL ? qscore(double(edits.get_score(q)) / orig_score) : 0;
+            float all_qscore = type == TYPE_ALL ? qscore(double(this->scores[q-g.min_qual]) / orig_score) : 0;
 
             // print summary
             fprintf(dists_summ, "%s\t%d\t%d\t%d\t%f\t%f\t%f\n", type_strs2[type].data(),
@@ -600,36 +670,25 @@ void write_distance(const editData & edits) {
 /*******************************************************************************/
 
 
-void write_results(
+void resultsWriter::write_results(
         std::unique_ptr<phaseData> & phasedata_ptr, 
         const editData & edits) {
-    if (g.verbosity >= 1) INFO(" ");
-    if (g.verbosity >= 1) INFO("%s[8/8] Writing results%s", COLOR_PURPLE, COLOR_WHITE);
-
-    // print summary (precision/recall) information
-    write_precision_recall(phasedata_ptr);
 
-    // print distance information
-    write_distance(edits);
+    // accumulate summary (precision/recall) and distance information
+    this->add_precision_recall(phasedata_ptr);
+    this->add_distance(edits);
 
     // print edit information
-    std::string edit_fn = g.out_prefix + "edits.tsv";
-    FILE* out_edits = fopen(edit_fn.data(), "w");
-    fprintf(out_edits, "CONTIG\tSTART\tHAP\tTYPE\tSIZE\tSUPERCLUSTER\tQUAL\n");
-    if (g.verbosity >= 1) INFO("  Printing edit results to '%s'", edit_fn.data());
+    FILE* out_edits = this->out_edits;
     for (int i = 0; i < edits.n; i++) {
         fprintf(out_edits, "%s\t%d\t%d\t%s\t%d\t%d\t%d\n", 
-                edits.ctgs[i].data(), edits.poss[i], edits.haps[i],
+                ctg_dict.name(edits.ctgs[i]).data(), edits.poss[i], edits.haps[i],
                 type_strs[edits.types[i]].data(), edits.lens[i],
                 edits.superclusters[i], edits.quals[i]);
     }
-    fclose(out_edits);
 
     // print phasing information
-    std::string out_phasings_fn = g.out_prefix + "phase-blocks.tsv";
-    FILE* out_phasings = fopen(out_phasings_fn.data(), "w");
-    if (g.verbosity >= 1) INFO("  Printing phasing results to '%s'", out_phasings_fn.data());
-    fprintf(out_phasings, "CONTIG\tSTART\tSTOP\tSIZE\tSUPERCLUSTERS\n");
+    FILE* out_phasings = this->out_phasings;
     for (auto ctg : phasedata_ptr->contigs) {
         auto & ctg_phasings = phasedata_ptr->ctg_phasings[ctg];
         std::shared_ptr<ctgSuperclusters> ctg_superclusters = ctg_phasings->ctg_superclusters;
@@ -639,17 +698,12 @@ void write_results(
             int beg = ctg_superclusters->begs[beg_idx];
             int end = ctg_superclusters->ends[end_idx];
             fprintf(out_phasings, "%s\t%d\t%d\t%d\t%d\n", 
-                    ctg.data(), beg, end, end-beg, end_idx-beg_idx+1);
+                    ctg_dict.name(ctg).data(), beg, end, end-beg, end_idx-beg_idx+1);
         }
     }
-    fclose(out_phasings);
 
     // print clustering information
-    std::string out_clusterings_fn = g.out_prefix + "superclusters.tsv";
-    FILE* out_clusterings = fopen(out_clusterings_fn.data(), "w");
-    if (g.verbosity >= 1) INFO("  Printing superclustering results to '%s'", out_clusterings_fn.data());
-    fprintf(out_clusterings, "CONTIG\tSTART\tSTOP\tSIZE\tQUERY1_VARS\tQUERY2_VARS"
-            "\tTRUTH1_VARS\tTRUTH2_VARS\tORIG_ED\tSWAP_ED\tPHASE\tPHASE_BLOCK\n");
+    FILE* out_clusterings = this->out_clusterings;
     for (auto ctg : phasedata_ptr->contigs) {
         auto & ctg_phasings = phasedata_ptr->ctg_phasings[ctg];
         std::shared_ptr<ctgSuperclusters> ctg_supclusts = ctg_phasings->ctg_superclusters;
@@ -685,7 +739,7 @@ void write_results(
 
             // print data
             fprintf(out_clusterings, "%s\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%s\t%d\n", 
-                ctg.data(), 
+                ctg_dict.name(ctg).data(), 
                 ctg_supclusts->begs[i],
                 ctg_supclusts->ends[i],
                 ctg_supclusts->ends[i] - ctg_supclusts->begs[i],
@@ -697,14 +751,9 @@ void write_results(
            );
         }
     }
-    fclose(out_clusterings);
 
     // print query variant information
-    std::string out_query_fn = g.out_prefix + "query.tsv";
-    if (g.verbosity >= 1) INFO("  Printing call variant results to '%s'", out_query_fn.data());
-    FILE* out_query = fopen(out_query_fn.data(), "w");
-    fprintf(out_query, "CONTIG\tPOS\tHAP\tREF\tALT\tQUAL\tTYPE\tERR_TYPE"
-            "\tCREDIT\tCLUSTER\tSUPERCLUSTER\tLOCATION\n");
+    FILE* out_query = this->out_query;
     for (auto ctg : phasedata_ptr->contigs) {
 
         // set pointers to variants and superclusters
@@ -732,12 +781,12 @@ void write_results(
                     ERROR("Out of bounds supercluster during write_results(): query1")
                 while (query1_vars->poss[var1_idx] >= ctg_supclusts->ends[supercluster_idx])
                     supercluster_idx++;
-                fprintf(out_query, "%s\t%d\t%d\t%s\t%s\t%.2f\t%s\t%s\t%f\t%d\t%d\t%s\n",
-                        ctg.data(),
+                fprintf(out_query, "%s\t%d\t%d\t%.*s\t%.*s\t%.2f\t%s\t%s\t%f\t%d\t%d\t%s\n",
+                        ctg_dict.name(ctg).data(),
                         query1_vars->poss[var1_idx],
                         query1_vars->haps[var1_idx],
-                        query1_vars->refs[var1_idx].data(),
-                        query1_vars->alts[var1_idx].data(),
+                        query1_vars->ref_lens[var1_idx], query1_vars->ref(var1_idx).data(),
+                        query1_vars->alt_lens[var1_idx], query1_vars->alt(var1_idx).data(),
                         query1_vars->var_quals[var1_idx],
                         type_strs[query1_vars->types[var1_idx]].data(),
                         error_strs[query1_vars->errtypes[var1_idx]].data(),
@@ -755,12 +804,12 @@ void write_results(
                     ERROR("Out of bounds supercluster during write_results(): query2")
                 while (query2_vars->poss[var2_idx] >= ctg_supclusts->ends[supercluster_idx])
                     supercluster_idx++;
-                fprintf(out_query, "%s\t%d\t%d\t%s\t%s\t%.2f\t%s\t%s\t%f\t%d\t%d\t%s\n",
-                        ctg.data(),
+                fprintf(out_query, "%s\t%d\t%d\t%.*s\t%.*s\t%.2f\t%s\t%s\t%f\t%d\t%d\t%s\n",
+                        ctg_dict.name(ctg).data(),
                         query2_vars->poss[var2_idx],
                         query2_vars->haps[var2_idx],
-                        query2_vars->refs[var2_idx].data(),
-                        query2_vars->alts[var2_idx].data(),
+                        query2_vars->ref_lens[var2_idx], query2_vars->ref(var2_idx).data(),
+                        query2_vars->alt_lens[var2_idx], query2_vars->alt(var2_idx).data(),
                         query2_vars->var_quals[var2_idx],
                         type_strs[query2_vars->types[var2_idx]].data(),
                         error_strs[query2_vars->errtypes[var2_idx]].data(),
@@ -773,13 +822,9 @@ void write_results(
             }
         }
     }
-    fclose(out_query);
     
     //print truth variant information
-    std::string out_truth_fn = g.out_prefix + "truth.tsv";
-    if (g.verbosity >= 1) INFO("  Printing truth variant results to '%s'", out_truth_fn.data());
-    FILE* out_truth = fopen(out_truth_fn.data(), "w");
-    fprintf(out_truth, "CONTIG\tPOS\tHAP\tREF\tALT\tQUAL\tTYPE\tERRTYPE\tCREDIT\tCLUSTER\tSUPERCLUSTER\tLOCATION\n");
+    FILE* out_truth = this->out_truth;
     for (auto ctg : phasedata_ptr->contigs) {
 
         // set pointers to variants and superclusters
@@ -805,12 +850,12 @@ void write_results(
                     ERROR("Out of bounds supercluster during write_results(): truth1")
                 while (truth1_vars->poss[var1_idx] >= ctg_supclusts->ends[supercluster_idx])
                     supercluster_idx++;
-                fprintf(out_truth, "%s\t%d\t%d\t%s\t%s\t%.2f\t%s\t%s\t%f\t%d\t%d\t%s\n",
-                        ctg.data(),
+                fprintf(out_truth, "%s\t%d\t%d\t%.*s\t%.*s\t%.2f\t%s\t%s\t%f\t%d\t%d\t%s\n",
+                        ctg_dict.name(ctg).data(),
                         truth1_vars->poss[var1_idx],
                         truth1_vars->haps[var1_idx],
-                        truth1_vars->refs[var1_idx].data(),
-                        truth1_vars->alts[var1_idx].data(),
+                        truth1_vars->ref_lens[var1_idx], truth1_vars->ref(var1_idx).data(),
+                        truth1_vars->alt_lens[var1_idx], truth1_vars->alt(var1_idx).data(),
                         truth1_vars->var_quals[var1_idx],
                         type_strs[truth1_vars->types[var1_idx]].data(),
                         error_strs[truth1_vars->errtypes[var1_idx]].data(),
@@ -829,12 +874,12 @@ void write_results(
                     ERROR("Out of bounds supercluster during write_results(): truth2")
                 while (truth2_vars->poss[var2_idx] >= ctg_supclusts->ends[supercluster_idx])
                     supercluster_idx++;
-                fprintf(out_truth, "%s\t%d\t%d\t%s\t%s\t%.2f\t%s\t%s\t%f\t%d\t%d\t%s\n",
-                        ctg.data(),
+                fprintf(out_truth, "%s\t%d\t%d\t%.*s\t%.*s\t%.2f\t%s\t%s\t%f\t%d\t%d\t%s\n",
+                        ctg_dict.name(ctg).data(),
                         truth2_vars->poss[var2_idx],
                         truth2_vars->haps[var2_idx],
-                        truth2_vars->refs[var2_idx].data(),
-                        truth2_vars->alts[var2_idx].data(),
+                        truth2_vars->ref_lens[var2_idx], truth2_vars->ref(var2_idx).data(),
+                        truth2_vars->alt_lens[var2_idx], truth2_vars->alt(var2_idx).data(),
                         truth2_vars->var_quals[var2_idx],
                         type_strs[truth2_vars->types[var2_idx]].data(),
                         error_strs[truth2_vars->errtypes[var2_idx]].data(),
@@ -847,9 +892,50 @@ void write_results(
             }
         }
     }
-    fclose(out_truth);
 
-    return;
+    // print GA4GH-compatible summary VCF
+    phasedata_ptr->write_summary_vcf(this->out_summary_vcf);
+}
+
+
+/*******************************************************************************/
+
+
+void resultsWriter::close() {
+    fclose(this->out_query_vcf);
+    fclose(this->out_truth_vcf);
+    if (g.exit) return;
+
+    if (g.verbosity >= 1) INFO(" ");
+    if (g.verbosity >= 1) INFO("%s[8/8] Writing results%s", COLOR_PURPLE, COLOR_WHITE);
+
+    // print summary (precision/recall) information
+    this->write_precision_recall();
+
+    // print distance information
+    this->write_distance();
+
+    // remaining results were written as each window of contigs completed
+    if (g.verbosity >= 1) {
+        INFO("  Printing edit results to '%s'", 
+                (g.out_prefix + "edits.tsv").data());
+        INFO("  Printing phasing results to '%s'", 
+                (g.out_prefix + "phase-blocks.tsv").data());
+        INFO("  Printing superclustering results to '%s'", 
+                (g.out_prefix + "superclusters.tsv").data());
+        INFO("  Printing call variant results to '%s'", 
+                (g.out_prefix + "query.tsv").data());
+        INFO("  Printing truth variant results to '%s'", 
+                (g.out_prefix + "truth.tsv").data());
+        INFO("  Printing GA4GH-compatible summary VCF to '%s'", 
+                (g.out_prefix + "summary.vcf").data());
+    }
+    fclose(this->out_edits);
+    fclose(this->out_phasings);
+    fclose(this->out_clusterings);
+    fclose(this->out_query);
+    fclose(this->out_truth);
+    fclose(this->out_summary_vcf);
 }
 
 
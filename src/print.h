@@ -37,6 +37,42 @@ void print_wfa_ptrs(
         const std::vector< std::vector< std::vector<uint8_t> > > & ptrs,
         const std::vector< std::vector< std::vector<int> > > & offs);
 
-void write_results(std::unique_ptr<phaseData> & phasings, const editData & edits);
+/* Writes one sample's results, a window of contigs at a time. Per-variant
+ * results are appended as each window is evaluated; precision-recall and
+ * distance totals are accumulated and only summarized on close().
+ */
+class resultsWriter {
+public:
+    resultsWriter(std::shared_ptr<variantData> query_ptr,
+            std::shared_ptr<variantData> truth_ptr);
+
+    void write_vcfs(std::shared_ptr<variantData> query_ptr,
+            std::shared_ptr<variantData> truth_ptr);
+    void write_results(std::unique_ptr<phaseData> & phasedata_ptr, 
+            const editData & edits);
+    void close();
+
+    void add_precision_recall(std::unique_ptr<phaseData> & phasedata_ptr);
+    void add_distance(const editData & edits);
+    void write_precision_recall();
+    void write_distance();
+
+    // output files, open until close()
+    FILE* out_query_vcf = NULL;
+    FILE* out_truth_vcf = NULL;
+    FILE* out_summary_vcf = NULL;
+    FILE* out_edits = NULL;
+    FILE* out_phasings = NULL;
+    FILE* out_clusterings = NULL;
+    FILE* out_query = NULL;
+    FILE* out_truth = NULL;
+
+    // running totals; ax0: SUB/INDEL, ax1: TP,FP,FN,PP,PP_FRAC, ax2: QUAL
+    std::vector< std::vector< std::vector<float> > > query_counts;
+    std::vector< std::vector< std::vector<float> > > truth_counts;
+    std::vector< std::vector<int> > edit_dists;     // [QUAL][TYPE]
+    std::vector< std::vector<int> > distinct_edits; // [QUAL][TYPE]
+    std::vector<int> scores;                        // [QUAL]
+};
 
 #endif
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cstring>
+
+#include "simd.h"
+#include "defs.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WF_SIMD
+#endif
+
+/******************************************************************************/
+
+/* Reference implementation, also used for band edges and vector remainders. */
+void wf_step_scalar(const wfStep & w, int beg, int end) {
+    int query_len = w.query_len;
+    int truth_len = w.truth_len;
+    int mat_len = query_len + truth_len - 1;
+
+    for (int i = beg; i < end; i++) {
+        int d = w.lo + i;
+        int diag = d + 1 - query_len;
+
+        // sub (in SUB)
+        int prev_off = w.sub_src ? w.sub_src[i] : -2;
+        if (prev_off != -2 && prev_off+1 < query_len &&
+                 diag + prev_off+1 < truth_len && prev_off+1 >= w.sub[i]) {
+            w.sub[i] = prev_off + 1;
+            if (w.sub_ptrs) w.sub_ptrs[i] |= PTR_SUB;
+        }
+
+        // open gap (enter DEL)
+        prev_off = w.open_src && d > 0 ? w.open_src[i-1] : -2;
+        if (prev_off != -2 && diag + prev_off < truth_len && prev_off >= w.del[i]) {
+            w.del[i] = prev_off;
+            if (w.del_ptrs) w.del_ptrs[i] |= PTR_SUB;
+        }
+
+        // open gap (enter INS)
+        prev_off = w.open_src && d < mat_len-1 ? w.open_src[i+1] : -2;
+        if (prev_off != -2 && prev_off+1 < query_len &&
+                diag + prev_off+1 < truth_len && diag + prev_off+1 >= 0 &&
+                prev_off+1 >= w.ins[i]) {
+            w.ins[i] = prev_off+1;
+            if (w.ins_ptrs) w.ins_ptrs[i] |= PTR_SUB;
+        }
+
+        // extend gap (stay DEL)
+        prev_off = w.del_src && d > 0 ? w.del_src[i-1] : -2;
+        if (prev_off != -2 && diag + prev_off < truth_len && prev_off >= w.del[i]) {
+            w.del[i] = prev_off;
+            if (w.del_ptrs) w.del_ptrs[i] |= PTR_DEL;
+        }
+
+        // extend gap (stay INS)
+        prev_off = w.ins_src && d < mat_len-1 ? w.ins_src[i+1] : -2;
+        if (prev_off != -2 && prev_off+1 < query_len &&
+                diag + prev_off+1 < truth_len && diag + prev_off+1 >= 0 &&
+                prev_off+1 >= w.ins[i]) {
+            w.ins[i] = prev_off+1;
+            if (w.ins_ptrs) w.ins_ptrs[i] |= PTR_INS;
+        }
+    }
+}
+
+/******************************************************************************/
+
+#ifdef WF_SIMD
+
+/* Vector kernels only cover interior diagonals (0 < d < mat_len-1), where both
+ * neighbouring source offsets exist; the rest is left to wf_step_scalar().
+ * Each transition computes a candidate offset and validity mask per lane,
+ * then takes the candidate if it reaches at least as far (ties set both
+ * pointer bits, as in the scalar code).
+ */
+
+__attribute__((target("avx2")))
+static inline __m256i take_avx2(__m256i & cur, __m256i off, __m256i ok) {
+    ok = _mm256_andnot_si256(_mm256_cmpgt_epi32(cur, off), ok);
+    cur = _mm256_blendv_epi8(cur, off, ok);
+    return ok;
+}
+
+__attribute__((target("avx2")))
+static inline void or_ptrs_avx2(uint8_t * ptrs, __m256i bits) {
+    // low byte of each 32-bit lane
+    const __m256i shuf = _mm256_setr_epi8(
+            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    bits = _mm256_shuffle_epi8(bits, shuf);
+    uint64_t add = uint32_t(_mm_cvtsi128_si32(_mm256_castsi256_si128(bits))) |
+        uint64_t(uint32_t(_mm_cvtsi128_si32(_mm256_extracti128_si256(bits, 1)))) << 32;
+    uint64_t old;
+    memcpy(&old, ptrs, 8);
+    old |= add;
+    memcpy(ptrs, &old, 8);
+}
+
+__attribute__((target("avx2")))
+void wf_step_avx2(const wfStep & w) {
+    int n = w.hi - w.lo + 1;
+    int mat_len = w.query_len + w.truth_len - 1;
+    int beg = std::max(w.lo, 1) - w.lo;
+    int end = std::min(w.hi, mat_len-2) - w.lo + 1;
+    if (end - beg < 8) { wf_step_scalar(w, 0, n); return; }
+    wf_step_scalar(w, 0, beg);
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i none = _mm256_set1_epi32(-2);
+    const __m256i query_len = _mm256_set1_epi32(w.query_len);
+    const __m256i truth_len = _mm256_set1_epi32(w.truth_len);
+    const __m256i ptr_sub = _mm256_set1_epi32(PTR_SUB);
+    const __m256i ptr_ins = _mm256_set1_epi32(PTR_INS);
+    const __m256i ptr_del = _mm256_set1_epi32(PTR_DEL);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    int i = beg;
+    for (; i + 8 <= end; i += 8) {
+        __m256i diag = _mm256_add_epi32(lanes,
+                _mm256_set1_epi32(w.lo + i + 1 - w.query_len));
+        __m256i ok, off;
+
+        // sub (in SUB)
+        if (w.sub_src) {
+            __m256i sub = _mm256_loadu_si256((const __m256i *) (w.sub + i));
+            __m256i prev = _mm256_loadu_si256((const __m256i *) (w.sub_src + i));
+            off = _mm256_add_epi32(prev, one);
+            ok = _mm256_andnot_si256(_mm256_cmpeq_epi32(prev, none),
+                    _mm256_cmpgt_epi32(query_len, off));
+            ok = _mm256_and_si256(ok, _mm256_cmpgt_epi32(truth_len,
+                        _mm256_add_epi32(diag, off)));
+            ok = take_avx2(sub, off, ok);
+            _mm256_storeu_si256((__m256i *) (w.sub + i), sub);
+            if (w.sub_ptrs) or_ptrs_avx2(w.sub_ptrs + i,
+                    _mm256_and_si256(ok, ptr_sub));
+        }
+
+        // DEL: open gap, then extend gap
+        if (w.open_src || w.del_src) {
+            __m256i del = _mm256_loadu_si256((const __m256i *) (w.del + i));
+            __m256i ptrs = zero;
+            for (int t = 0; t < 2; t++) {
+                const int * src = t ? w.del_src : w.open_src;
+                if (!src) continue;
+                off = _mm256_loadu_si256((const __m256i *) (src + i-1));
+                ok = _mm256_andnot_si256(_mm256_cmpeq_epi32(off, none),
+                        _mm256_cmpgt_epi32(truth_len, _mm256_add_epi32(diag, off)));
+                ok = take_avx2(del, off, ok);
+                ptrs = _mm256_or_si256(ptrs,
+                        _mm256_and_si256(ok, t ? ptr_del : ptr_sub));
+            }
+            _mm256_storeu_si256((__m256i *) (w.del + i), del);
+            if (w.del_ptrs) or_ptrs_avx2(w.del_ptrs + i, ptrs);
+        }
+
+        // INS: open gap, then extend gap
+        if (w.open_src || w.ins_src) {
+            __m256i ins = _mm256_loadu_si256((const __m256i *) (w.ins + i));
+            __m256i ptrs = zero;
+            for (int t = 0; t < 2; t++) {
+                const int * src = t ? w.ins_src : w.open_src;
+                if (!src) continue;
+                __m256i prev = _mm256_loadu_si256((const __m256i *) (src + i+1));
+                off = _mm256_add_epi32(prev, one);
+                __m256i reach = _mm256_add_epi32(diag, off);
+                ok = _mm256_andnot_si256(_mm256_cmpeq_epi32(prev, none),
+                        _mm256_cmpgt_epi32(query_len, off));
+                ok = _mm256_and_si256(ok, _mm256_cmpgt_epi32(truth_len, reach));
+                ok = _mm256_andnot_si256(_mm256_cmpgt_epi32(zero, reach), ok);
+                ok = take_avx2(ins, off, ok);
+                ptrs = _mm256_or_si256(ptrs,
+                        _mm256_and_si256(ok, t ? ptr_ins : ptr_sub));
+            }
+            _mm256_storeu_si256((__m256i *) (w.ins + i), ins);
+            if (w.ins_ptrs) or_ptrs_avx2(w.ins_ptrs + i, ptrs);
+        }
+    }
+    wf_step_scalar(w, i, n);
+}
+
+/******************************************************************************/
+
+__attribute__((target("sse4.1")))
+static inline __m128i take_sse41(__m128i & cur, __m128i off, __m128i ok) {
+    ok = _mm_andnot_si128(_mm_cmpgt_epi32(cur, off), ok);
+    cur = _mm_blendv_epi8(cur, off, ok);
+    return ok;
+}
+
+__attribute__((target("sse4.1")))
+static inline void or_ptrs_sse41(uint8_t * ptrs, __m128i bits) {
+    // low byte of each 32-bit lane
+    const __m128i shuf = _mm_setr_epi8(
+            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    uint32_t add = _mm_cvtsi128_si32(_mm_shuffle_epi8(bits, shuf));
+    uint32_t old;
+    memcpy(&old, ptrs, 4);
+    old |= add;
+    memcpy(ptrs, &old, 4);
+}
+
+__attribute__((target("sse4.1")))
+void wf_step_sse41(const wfStep & w) {
+    int n = w.hi - w.lo + 1;
+    int mat_len = w.query_len + w.truth_len - 1;
+    int beg = std::max(w.lo, 1) - w.lo;
+    int end = std::min(w.hi, mat_len-2) - w.lo + 1;
+    if (end - beg < 4) { wf_step_scalar(w, 0, n); return; }
+    wf_step_scalar(w, 0, beg);
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i none = _mm_set1_epi32(-2);
+    const __m128i query_len = _mm_set1_epi32(w.query_len);
+    const __m128i truth_len = _mm_set1_epi32(w.truth_len);
+    const __m128i ptr_sub = _mm_set1_epi32(PTR_SUB);
+    const __m128i ptr_ins = _mm_set1_epi32(PTR_INS);
+    const __m128i ptr_del = _mm_set1_epi32(PTR_DEL);
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+    int i = beg;
+    for (; i + 4 <= end; i += 4) {
+        __m128i diag = _mm_add_epi32(lanes,
+                _mm_set1_epi32(w.lo + i + 1 - w.query_len));
+        __m128i ok, off;
+
+        // sub (in SUB)
+        if (w.sub_src) {
+            __m128i sub = _mm_loadu_si128((const __m128i *) (w.sub + i));
+            __m128i prev = _mm_loadu_si128((const __m128i *) (w.sub_src + i));
+            off = _mm_add_epi32(prev, one);
+            ok = _mm_andnot_si128(_mm_cmpeq_epi32(prev, none),
+                    _mm_cmpgt_epi32(query_len, off));
+            ok = _mm_and_si128(ok, _mm_cmpgt_epi32(truth_len,
+                        _mm_add_epi32(diag, off)));
+            ok = take_sse41(sub, off, ok);
+            _mm_storeu_si128((__m128i *) (w.sub + i), sub);
+            if (w.sub_ptrs) or_ptrs_sse41(w.sub_ptrs + i,
+                    _mm_and_si128(ok, ptr_sub));
+        }
+
+        // DEL: open gap, then extend gap
+        if (w.open_src || w.del_src) {
+            __m128i del = _mm_loadu_si128((const __m128i *) (w.del + i));
+            __m128i ptrs = zero;
+            for (int t = 0; t < 2; t++) {
+                const int * src = t ? w.del_src : w.open_src;
+                if (!src) continue;
+                off = _mm_loadu_si128((const __m128i *) (src + i-1));
+                ok = _mm_andnot_si128(_mm_cmpeq_epi32(off, none),
+                        _mm_cmpgt_epi32(truth_len, _mm_add_epi32(diag, off)));
+                ok = take_sse41(del, off, ok);
+                ptrs = _mm_or_si128(ptrs,
+                        _mm_and_si128(ok, t ? ptr_del : ptr_sub));
+            }
+            _mm_storeu_si128((__m128i *) (w.del + i), del);
+            if (w.del_ptrs) or_ptrs_sse41(w.del_ptrs + i, ptrs);
+        }
+
+        // INS: open gap, then extend gap
+        if (w.open_src || w.ins_src) {
+            __m128i ins = _mm_loadu_si128((const __m128i *) (w.ins + i));
+            __m128i ptrs = zero;
+            for (int t = 0; t < 2; t++) {
+                const int * src = t ? w.ins_src : w.open_src;
+                if (!src) continue;
+                __m128i prev = _mm_loadu_si128((const __m128i *) (src + i+1));
+                off = _mm_add_epi32(prev, one);
+                __m128i reach = _mm_add_epi32(diag, off);
+                ok = _mm_andnot_si128(_mm_cmpeq_epi32(prev, none),
+                        _mm_cmpgt_epi32(query_len, off));
+                ok = _mm_and_si128(ok, _mm_cmpgt_epi32(truth_len, reach));
+                ok = _mm_andnot_si128(_mm_cmpgt_epi32(zero, reach), ok);
+                ok = take_sse41(ins, off, ok);
+                ptrs = _mm_or_si128(ptrs,
+                        _mm_and_si128(ok, t ? ptr_ins : ptr_sub));
+            }
+            _mm_storeu_si128((__m128i *) (w.ins + i), ins);
+            if (w.ins_ptrs) or_ptrs_sse41(w.ins_ptrs + i, ptrs);
+        }
+    }
+    wf_step_scalar(w, i, n);
+}
+
+#else
+
+void wf_step_avx2(const wfStep & w) { wf_step_scalar(w, 0, w.hi - w.lo + 1); }
+void wf_step_sse41(const wfStep & w) { wf_step_scalar(w, 0, w.hi - w.lo + 1); }
+
+#endif
+
+/******************************************************************************/
+
+void wf_step_default(const wfStep & w) { wf_step_scalar(w, 0, w.hi - w.lo + 1); }
+
+/* Select the widest kernel supported by this CPU, once. */
+void wf_step(const wfStep & step) {
+    static void (* const kernel)(const wfStep &) = []() {
+#ifdef WF_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return wf_step_avx2;
+        if (__builtin_cpu_supports("sse4.1")) return wf_step_sse41;
+#endif
+        return wf_step_default;
+    }();
+    kernel(step);
+}
@@ -0,0 +1,35 @@
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+#include <cstdint>
+
+/* One next-score step of gap-affine wavefront alignment, for target
+ * diagonals [lo, hi]. All offset rows are indexed by d - lo; target rows are
+ * updated in place (a step only ever increases an offset). Sources must be
+ * readable at d-1 and d+1 wherever 0 < d < mat_len-1, and a NULL source
+ * skips its transition (e.g. score not yet reached). Pointer rows are
+ * optional: if NULL, only offsets are computed.
+ */
+class wfStep {
+public:
+    int lo, hi;
+    int query_len, truth_len;
+    const int * sub_src = NULL;      // SUB at s-x      -> SUB (sub)
+    const int * open_src = NULL;     // SUB at gap open -> INS, DEL (open)
+    const int * del_src = NULL;      // DEL at s-e      -> DEL (extend)
+    const int * ins_src = NULL;      // INS at s-e      -> INS (extend)
+    int * sub = NULL;
+    int * del = NULL;
+    int * ins = NULL;
+    uint8_t * sub_ptrs = NULL;
+    uint8_t * del_ptrs = NULL;
+    uint8_t * ins_ptrs = NULL;
+};
+
+void wf_step(const wfStep & step);   // dispatches on CPU features
+
+void wf_step_scalar(const wfStep & step, int beg, int end);
+void wf_step_sse41(const wfStep & step);
+void wf_step_avx2(const wfStep & step);
+
+#endif
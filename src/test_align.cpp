@@ -0,0 +1,118 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "globals.h"
+#include "dist.h"
+
+Globals g;
+contigDict ctg_dict;
+std::vector<std::string> type_strs = {"REF", "SNP", "INS", "DEL", "CPX"};
+std::vector<std::string> type_strs2 = {"ALL", "SNP", "INS", "DEL", "INDEL"};
+std::vector<std::string> vartype_strs = {"SNP", "INDEL"};
+std::vector<std::string> error_strs = {"TP", "FP", "FN", "PP", "PE", "GE", "??"};
+std::vector<std::string> gt_strs = {
+        "0", "1", "0|0", "0|1", "1|0", "1|1", "1|2", "2|1", ".|.", "M|N" };
+std::vector<std::string> region_strs = {"OUTSIDE", "INSIDE ", "BORDER ", "OFF CTG"};
+std::vector<std::string> aln_strs = {"QUERY1-TRUTH1", "QUERY1-TRUTH2", "QUERY2-TRUTH1", "QUERY2-TRUTH2"};
+std::vector<std::string> callset_strs = {"QUERY", "TRUTH"};
+std::vector<std::string> phase_strs = {"=", "X", "?"};
+std::vector<std::string> timer_strs = {"reading", "clustering", "realigning", 
+    "reclustering", "superclustering", "precision/recall", "edit distance", "phasing", "writing", "total"};
+
+/* Print mode always runs the scalar per-diagonal step, so any wavefront it 
+ * computes is the reference for the non-print (vectorized) step. Sequences 
+ * are kept short: zero penalties leave the band unbounded.
+ */
+int test_align(const std::string & query, const std::string & truth,
+        int x, int o, int e) {
+    swgWavefronts print_wf, wf;
+    int print_s = 0, s = 0;
+    wf_swg_align(query, truth, print_wf, print_s, x, o, e, true);
+    wf_swg_align(query, truth, wf, s, x, o, e, false);
+
+    int fails = 0;
+    if (s != print_s) {
+        fprintf(stderr, "FAIL x=%d o=%d e=%d %s %s: score %d, print mode %d\n",
+                x, o, e, query.data(), truth.data(), s, print_s);
+        return 1;
+    }
+    for (int si = 0; si <= s; si++) {
+        for (int m = 0; m < MATS; m++) {
+            if (wf.offs[m][si] != print_wf.offs[m][si] ||
+                    wf.ptrs[m][si] != print_wf.ptrs[m][si]) {
+                fprintf(stderr, "FAIL x=%d o=%d e=%d %s %s: %s wavefront %d differs\n",
+                        x, o, e, query.data(), truth.data(), 
+                        type_strs[m+1].data(), si);
+                fails++;
+            }
+        }
+    }
+    return fails;
+}
+
+/* Backtracking with a tiny `max_cells` releases and recomputes wavefronts 
+ * from checkpoints, which must give the same CIGAR as full storage.
+ */
+int test_checkpoints(const std::string & query, const std::string & truth,
+        int x, int o, int e) {
+    swgWavefronts full_wf, wf;
+    wf.max_cells = 40;
+    wf.checkpoints = 2;
+    int full_s = 0, s = 0;
+    wf_swg_align(query, truth, full_wf, full_s, x, o, e, false);
+    wf_swg_align(query, truth, wf, s, x, o, e, false);
+    if (!wf.interval) {
+        fprintf(stderr, "FAIL x=%d o=%d e=%d: checkpointing not enabled\n", x, o, e);
+        return 1;
+    }
+    if (s != full_s || wf_swg_backtrack(query, truth, wf, s, x, o, e) !=
+            wf_swg_backtrack(query, truth, full_wf, full_s, x, o, e)) {
+        fprintf(stderr, "FAIL x=%d o=%d e=%d: checkpointed CIGAR differs\n", x, o, e);
+        return 1;
+    }
+    return 0;
+}
+
+/* Deterministic pseudo-random sequence and a copy with scattered edits. */
+std::pair<std::string, std::string> mutated_pair(int len, unsigned seed) {
+    auto next = [&seed]() { seed = seed * 1103515245 + 12345; return seed >> 16; };
+    std::string truth;
+    for (int i = 0; i < len; i++) truth += "ACGT"[next() % 4];
+    std::string query;
+    for (int i = 0; i < len; i++) {
+        switch (next() % 40) {
+            case 0: query += "ACGT"[next() % 4]; break;           // SNP
+            case 1: query += truth[i]; query += "ACGT"[next() % 4]; break; // INS
+            case 2: break;                                        // DEL
+            default: query += truth[i];
+        }
+    }
+    return {query, truth};
+}
+
+int main() {
+    std::vector< std::pair<std::string, std::string> > seqs = {
+        {"ACGTACGT", "ACTTACGAT"},
+        {"AAGGTTCA", "AGTTTCCAG"},
+        {"CATTAGA", "CTTAGGA"},
+        {"GATTACA", "GATTACA"},
+    };
+    std::vector< std::vector<int> > penalties = { // x, o, e
+        {0, 1, 1}, {1, 1, 0}, {2, 0, 0}, {5, 6, 2}, {3, 2, 1}, {1, 0, 1}
+    };
+
+    int fails = 0;
+    for (auto & [query, truth] : seqs)
+        for (auto & p : penalties)
+            fails += test_align(query, truth, p[0], p[1], p[2]);
+
+    for (unsigned seed = 1; seed <= 20; seed++) {
+        auto [query, truth] = mutated_pair(200 + 15 * seed, seed);
+        fails += test_checkpoints(query, truth, 5, 6, 2);
+        fails += test_checkpoints(query, truth, 3, 2, 1);
+    }
+
+    fprintf(stderr, "%s\n", fails ? "TESTS FAILED" : "TESTS PASSED");
+    return fails ? 1 : 0;
+}
@@ -2,13 +2,19 @@
 #include <unordered_map>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <thread>
+#include <mutex>
 
 #include "htslib/vcf.h"
+#include "htslib/tbx.h"
 
 #include "variant.h"
 #include "print.h"
 #include "dist.h"
 
+std::mutex summary_mutex;
+
 /******************************************************************************/
 
 ctgVariants::ctgVariants() { 
@@ -18,14 +24,18 @@ ctgVariants::ctgVariants() {
 void ctgVariants::add_cluster(int g) { this->clusters.push_back(g); }
 
 void ctgVariants::add_var(int pos, int rlen, uint8_t hap, uint8_t type, uint8_t loc,
-        std::string ref, std::string alt, uint8_t orig_gt, float gq, float vq) {
+        std::string_view ref, std::string_view alt, 
+        uint8_t orig_gt, float gq, float vq) {
     this->poss.push_back(pos);
     this->rlens.push_back(rlen);
     this->haps.push_back(hap);
     this->types.push_back(type);
     this->locs.push_back(loc);
-    this->refs.push_back(ref);
-    this->alts.push_back(alt);
+    this->allele_offs.push_back(this->alleles.size());
+    this->ref_lens.push_back(ref.size());
+    this->alt_lens.push_back(alt.size());
+    this->alleles += ref;
+    this->alleles += alt;
     this->orig_gts.push_back(orig_gt);
     this->gt_quals.push_back(gq);
     this->var_quals.push_back(std::min(vq, float(g.max_qual)));
@@ -36,13 +46,106 @@ void ctgVariants::add_var(int pos, int rlen, uint8_t hap, uint8_t type, uint8_t
     this->callq.push_back(0);
 }
 
+/* Copy variants from `cigar` string to `ctgVariants`. */
+void ctgVariants::add_variants(
+        const std::vector<int> & cigar, 
+        int hap, int ref_pos,
+        std::string_view query, 
+        std::string_view ref, 
+        int qual) {
+
+    int query_idx = 0;
+    int ref_idx = 0;
+    for (size_t cig_idx = 0; cig_idx < cigar.size(); ) {
+        int indel_len = 0;
+        switch (cigar[cig_idx]) {
+
+            case PTR_MAT: // no variant, update pointers
+                cig_idx += 2;
+                ref_idx++;
+                query_idx++;
+                break;
+
+            case PTR_SUB: // substitution
+                cig_idx += 2;
+                this->add_var(ref_pos+ref_idx, 1, hap, 
+                        TYPE_SUB, BED_INSIDE, ref.substr(ref_idx, 1), 
+                        query.substr(query_idx, 1), 
+                        GT_REF_REF, g.max_qual, qual);
+                ref_idx++;
+                query_idx++;
+                break;
+
+            case PTR_DEL: // deletion
+                cig_idx++; indel_len++;
+
+                // multi-base deletion
+                while (cig_idx < cigar.size() && cigar[cig_idx] == PTR_DEL) {
+                    cig_idx++; indel_len++;
+                }
+                this->add_var(ref_pos+ref_idx,
+                        indel_len, hap, TYPE_DEL, BED_INSIDE,
+                        ref.substr(ref_idx, indel_len),
+                        "", GT_REF_REF, g.max_qual, qual);
+                ref_idx += indel_len;
+                break;
+
+            case PTR_INS: // insertion
+                cig_idx++; indel_len++;
+
+                // multi-base insertion
+                while (cig_idx < cigar.size() && cigar[cig_idx] == PTR_INS) {
+                    cig_idx++; indel_len++;
+                }
+                this->add_var(ref_pos+ref_idx,
+                        0, hap, TYPE_INS, BED_INSIDE, "", 
+                        query.substr(query_idx, indel_len), 
+                        GT_REF_REF, g.max_qual, qual);
+                query_idx += indel_len;
+                break;
+        }
+    }
+}
+
+
+/* Append all variants of `other`, which must follow this struct's variants.
+ * Clusters are not copied, since they are recomputed after realignment.
+ */
+void ctgVariants::append(const ctgVariants & other) {
+    int alleles_size = this->alleles.size();
+    this->poss.insert(this->poss.end(), other.poss.begin(), other.poss.end());
+    this->rlens.insert(this->rlens.end(), other.rlens.begin(), other.rlens.end());
+    this->haps.insert(this->haps.end(), other.haps.begin(), other.haps.end());
+    this->types.insert(this->types.end(), other.types.begin(), other.types.end());
+    this->locs.insert(this->locs.end(), other.locs.begin(), other.locs.end());
+    for (int off : other.allele_offs)
+        this->allele_offs.push_back(alleles_size + off);
+    this->ref_lens.insert(this->ref_lens.end(), 
+            other.ref_lens.begin(), other.ref_lens.end());
+    this->alt_lens.insert(this->alt_lens.end(), 
+            other.alt_lens.begin(), other.alt_lens.end());
+    this->alleles += other.alleles;
+    this->orig_gts.insert(this->orig_gts.end(), 
+            other.orig_gts.begin(), other.orig_gts.end());
+    this->gt_quals.insert(this->gt_quals.end(), 
+            other.gt_quals.begin(), other.gt_quals.end());
+    this->var_quals.insert(this->var_quals.end(), 
+            other.var_quals.begin(), other.var_quals.end());
+    this->n += other.n;
+
+    this->errtypes.insert(this->errtypes.end(), 
+            other.errtypes.begin(), other.errtypes.end());
+    this->credit.insert(this->credit.end(), other.credit.begin(), other.credit.end());
+    this->callq.insert(this->callq.end(), other.callq.begin(), other.callq.end());
+}
+
 /******************************************************************************/
 
 void variantData::left_shift() {
 
     // shift variants as far left as possible after realignment
     for (int hap = 0; hap < HAPS; hap++) {
-        for (std::string ctg : this->contigs) {
+        for (int ctg : this->contigs) {
             auto vars = this->ctg_variants[hap][ctg];
             for (int i = 0; i < vars->n; i++) {
 
@@ -52,11 +155,12 @@ void variantData::left_shift() {
                     while (match && vars->poss[i] > 0 && 
                             (i == 0 || vars->poss[i] > 
                             vars->poss[i-1] + vars->rlens[i-1]+1)) {
-                        int ins_size = vars->alts[i].size();
-                        char ref_base = this->ref->fasta.at(ctg)[vars->poss[i]-1];
-                        if (ref_base == vars->alts[i][ins_size-1]) {
-                            vars->alts[i] = ref_base + 
-                                    vars->alts[i].substr(0, ins_size-1);
+                        int ins_size = vars->alt_lens[i];
+                        char* alt = &vars->alleles[
+                                vars->allele_offs[i] + vars->ref_lens[i]];
+                        char ref_base = this->ref->seq(ctg)[vars->poss[i]-1];
+                        if (ref_base == alt[ins_size-1]) { // rotate in place
+                            std::rotate(alt, alt + ins_size-1, alt + ins_size);
                             vars->poss[i]--;
                         } else {
                             match = false;
@@ -70,11 +174,11 @@ void variantData::left_shift() {
                     while (match && vars->poss[i] > 0 && 
                             (i == 0 || vars->poss[i] > 
                             vars->poss[i-1] + vars->rlens[i-1]+1)) {
-                        int del_size = vars->refs[i].size();
-                        char ref_base = this->ref->fasta.at(ctg)[vars->poss[i]-1];
-                        if (ref_base == vars->refs[i][del_size-1]) {
-                            vars->refs[i] = ref_base + 
-                                    vars->refs[i].substr(0, del_size-1);
+                        int del_size = vars->ref_lens[i];
+                        char* ref = &vars->alleles[vars->allele_offs[i]];
+                        char ref_base = this->ref->seq(ctg)[vars->poss[i]-1];
+                        if (ref_base == ref[del_size-1]) { // rotate in place
+                            std::rotate(ref, ref + del_size-1, ref + del_size);
                             vars->poss[i]--;
                         } else {
                             match = false;
@@ -87,21 +191,22 @@ void variantData::left_shift() {
 
     // for each variant
     for (int hap = 0; hap < HAPS; hap++) {
-        for (std::string ctg : this->contigs) {
+        for (int ctg : this->contigs) {
             auto vars = this->ctg_variants[hap][ctg];
             for (int i = 0; i < vars->n; i++) {
 
                 // if we consume a ref base, and there's another variant at the
                 // same position (which doesn't, by definition), move this var
                 // afterwards
-                if (vars->refs[i].size() && i+1 < vars->n && 
+                if (vars->ref_lens[i] && i+1 < vars->n && 
                             vars->poss[i+1] == vars->poss[i]) {
                     std::swap(vars->rlens[i], vars->rlens[i+1]);
                     std::swap(vars->haps[i],  vars->haps[i+1]);
                     std::swap(vars->types[i], vars->types[i+1]);
                     std::swap(vars->locs[i],  vars->locs[i+1]);
-                    std::swap(vars->refs[i],  vars->refs[i+1]);
-                    std::swap(vars->alts[i],  vars->alts[i+1]);
+                    std::swap(vars->allele_offs[i], vars->allele_offs[i+1]);
+                    std::swap(vars->ref_lens[i],    vars->ref_lens[i+1]);
+                    std::swap(vars->alt_lens[i],    vars->alt_lens[i+1]);
                     std::swap(vars->orig_gts[i],   vars->orig_gts[i+1]);
                     std::swap(vars->gt_quals[i],   vars->gt_quals[i+1]);
                     std::swap(vars->var_quals[i],  vars->var_quals[i+1]);
@@ -114,9 +219,21 @@ void variantData::left_shift() {
 /******************************************************************************/
 
 void variantData::write_vcf(std::string out_vcf_fn) {
-
-    // VCF header
     FILE* out_vcf = fopen(out_vcf_fn.data(), "w");
+    this->write_vcf_header(out_vcf);
+    this->write_vcf_records(out_vcf);
+    fclose(out_vcf);
+}
+
+/* Append records (only) to a VCF written by write_vcf(), one window at a time. */
+void variantData::append_vcf(std::string out_vcf_fn) {
+    FILE* out_vcf = fopen(out_vcf_fn.data(), "a");
+    this->write_vcf_records(out_vcf);
+    fclose(out_vcf);
+}
+
+
+void variantData::write_vcf_header(FILE* out_vcf) {
     const std::chrono::time_point now{std::chrono::system_clock::now()};
     time_t tt = std::chrono::system_clock::to_time_t(now);
     tm local_time = *localtime(&tt);
@@ -125,14 +242,17 @@ void variantData::write_vcf(std::string out_vcf_fn) {
             local_time.tm_mon + 1, local_time.tm_mday);
     for (size_t i = 0; i < this->contigs.size(); i++)
         fprintf(out_vcf, "##contig=<ID=%s,length=%d,ploidy=%d>\n", 
-                this->contigs[i].data(), this->lengths[i], this->ploidy[i]);
+                ctg_dict.name(this->contigs[i]).data(), this->lengths[i], 
+                this->ploidy[i]);
     fprintf(out_vcf, "##FILTER=<ID=PASS,Description=\"All filters passed\">\n");
     fprintf(out_vcf, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n");
     fprintf(out_vcf, "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t%s\n",
             this->sample.data());
+}
+
 
-    // write variants
-    for (std::string ctg : this->contigs) {
+void variantData::write_vcf_records(FILE* out_vcf) {
+    for (int ctg : this->contigs) {
         std::vector<size_t> ptrs = {0, 0};
         int p = this->ploidy[std::find(contigs.begin(), contigs.end(), ctg) - contigs.begin()];
         while (ptrs[HAP1] < this->ctg_variants[HAP1][ctg]->poss.size() ||
@@ -157,44 +277,44 @@ void variantData::write_vcf(std::string out_vcf_fn) {
 
             // add variants to output VCF file
             if (hap1 && hap2) {
-                if (this->ctg_variants[HAP1][ctg]->refs[ptrs[HAP1]] == 
-                        this->ctg_variants[HAP2][ctg]->refs[ptrs[HAP2]] &&
-                        this->ctg_variants[HAP1][ctg]->alts[ptrs[HAP1]] == 
-                        this->ctg_variants[HAP2][ctg]->alts[ptrs[HAP2]]) {
+                if (this->ctg_variants[HAP1][ctg]->ref(ptrs[HAP1]) == 
+                        this->ctg_variants[HAP2][ctg]->ref(ptrs[HAP2]) &&
+                        this->ctg_variants[HAP1][ctg]->alt(ptrs[HAP1]) == 
+                        this->ctg_variants[HAP2][ctg]->alt(ptrs[HAP2])) {
                     
                     // homozygous variant (1|1)
                     print_variant(out_vcf, ctg, pos, 
                             this->ctg_variants[HAP1][ctg]->types[ptrs[HAP1]],
-                            this->ctg_variants[HAP1][ctg]->refs[ptrs[HAP1]],
-                            this->ctg_variants[HAP1][ctg]->alts[ptrs[HAP1]],
+                            this->ctg_variants[HAP1][ctg]->ref(ptrs[HAP1]),
+                            this->ctg_variants[HAP1][ctg]->alt(ptrs[HAP1]),
                             this->ctg_variants[HAP1][ctg]->var_quals[ptrs[HAP1]], "1|1");
                     
                 } else {
                     // two separate phased variants (0|1 + 1|0)
                     print_variant(out_vcf, ctg, pos, 
                             this->ctg_variants[HAP1][ctg]->types[ptrs[HAP1]],
-                            this->ctg_variants[HAP1][ctg]->refs[ptrs[HAP1]],
-                            this->ctg_variants[HAP1][ctg]->alts[ptrs[HAP1]],
+                            this->ctg_variants[HAP1][ctg]->ref(ptrs[HAP1]),
+                            this->ctg_variants[HAP1][ctg]->alt(ptrs[HAP1]),
                             this->ctg_variants[HAP1][ctg]->var_quals[ptrs[HAP1]], "1|0");
                     print_variant(out_vcf, ctg, pos, 
                             this->ctg_variants[HAP2][ctg]->types[ptrs[HAP2]],
-                            this->ctg_variants[HAP2][ctg]->refs[ptrs[HAP2]],
-                            this->ctg_variants[HAP2][ctg]->alts[ptrs[HAP2]],
+                            this->ctg_variants[HAP2][ctg]->ref(ptrs[HAP2]),
+                            this->ctg_variants[HAP2][ctg]->alt(ptrs[HAP2]),
                             this->ctg_variants[HAP2][ctg]->var_quals[ptrs[HAP2]], "0|1");
                 }
 
             } else if (hap1) { // 1|0
                 print_variant(out_vcf, ctg, pos, 
                         this->ctg_variants[HAP1][ctg]->types[ptrs[HAP1]],
-                        this->ctg_variants[HAP1][ctg]->refs[ptrs[HAP1]],
-                        this->ctg_variants[HAP1][ctg]->alts[ptrs[HAP1]],
+                        this->ctg_variants[HAP1][ctg]->ref(ptrs[HAP1]),
+                        this->ctg_variants[HAP1][ctg]->alt(ptrs[HAP1]),
                         this->ctg_variants[HAP1][ctg]->var_quals[ptrs[HAP1]], p == 1 ? "1" : "1|0");
 
             } else if (hap2) { // 0|1
                 print_variant(out_vcf, ctg, pos, 
                         this->ctg_variants[HAP2][ctg]->types[ptrs[HAP2]],
-                        this->ctg_variants[HAP2][ctg]->refs[ptrs[HAP2]],
-                        this->ctg_variants[HAP2][ctg]->alts[ptrs[HAP2]],
+                        this->ctg_variants[HAP2][ctg]->ref(ptrs[HAP2]),
+                        this->ctg_variants[HAP2][ctg]->alt(ptrs[HAP2]),
                         this->ctg_variants[HAP2][ctg]->var_quals[ptrs[HAP2]],  p == 1 ? "1" :"0|1");
             }
 
@@ -203,7 +323,6 @@ void variantData::write_vcf(std::string out_vcf_fn) {
             if (hap2) ptrs[HAP2]++;
         }
     }
-    fclose(out_vcf);
 }
 
 
@@ -211,20 +330,22 @@ void variantData::write_vcf(std::string out_vcf_fn) {
 
 
 void ctgVariants::print_var_info(FILE* out_fp, std::shared_ptr<fastaData> ref, 
-        std::string ctg, int idx) {
+        int ctg, int idx) {
     char ref_base;
     switch (this->types[idx]) {
     case TYPE_SUB:
-        fprintf(out_fp, "%s\t%d\t.\t%s\t%s\t.\tPASS\t.\tGT:BD:BK:BC:QQ:SC:SP", 
-                ctg.data(), this->poss[idx]+1, this->refs[idx].data(), 
-                this->alts[idx].data());
+        fprintf(out_fp, "%s\t%d\t.\t%.*s\t%.*s\t.\tPASS\t.\tGT:BD:BK:BC:QQ:SC:SP", 
+                ctg_dict.name(ctg).data(), this->poss[idx]+1, 
+                this->ref_lens[idx], this->ref(idx).data(), 
+                this->alt_lens[idx], this->alt(idx).data());
         break;
     case TYPE_INS:
     case TYPE_DEL:
-        ref_base = ref->fasta.at(ctg)[this->poss[idx]-1];
-        fprintf(out_fp, "%s\t%d\t.\t%s\t%s\t.\tPASS\t.\tGT:BD:BK:BC:QQ:SC:SP", ctg.data(), 
-                this->poss[idx], (ref_base + this->refs[idx]).data(), 
-                (ref_base + this->alts[idx]).data());
+        ref_base = ref->seq(ctg)[this->poss[idx]-1];
+        fprintf(out_fp, "%s\t%d\t.\t%c%.*s\t%c%.*s\t.\tPASS\t.\tGT:BD:BK:BC:QQ:SC:SP", 
+                ctg_dict.name(ctg).data(), this->poss[idx], 
+                ref_base, this->ref_lens[idx], this->ref(idx).data(), 
+                ref_base, this->alt_lens[idx], this->alt(idx).data());
         break;
     default:
         ERROR("print_variant not implemented for type %d", this->types[idx]);
@@ -259,24 +380,28 @@ void ctgVariants::print_var_sample(FILE* out_fp, int idx, std::string gt,
 /*******************************************************************************/
 
 
-void variantData::print_variant(FILE* out_fp, std::string ctg, int pos, int type,
-        std::string ref, std::string alt, float qual, std::string gt) {
+void variantData::print_variant(FILE* out_fp, int ctg, int pos, int type,
+        std::string_view ref, std::string_view alt, float qual, std::string gt) {
 
     char ref_base;
     switch (type) {
     case TYPE_SUB:
-        fprintf(out_fp, "%s\t%d\t.\t%s\t%s\t%f\tPASS\t.\tGT\t%s\n", ctg.data(),
-            pos+1, ref.data(), alt.data(), qual, gt.data());
+        fprintf(out_fp, "%s\t%d\t.\t%.*s\t%.*s\t%f\tPASS\t.\tGT\t%s\n", 
+            ctg_dict.name(ctg).data(),
+            pos+1, int(ref.size()), ref.data(), int(alt.size()), alt.data(), 
+            qual, gt.data());
         break;
     case TYPE_INS:
     case TYPE_DEL:
         try {
-            ref_base = this->ref->fasta.at(ctg)[pos];
-            fprintf(out_fp, "%s\t%d\t.\t%s\t%s\t%f\tPASS\t.\tGT\t%s\n", ctg.data(), 
-                    pos+1, (ref_base + ref).data(), (ref_base + alt).data(), 
-                    qual, gt.data());
+            ref_base = this->ref->seq(ctg)[pos];
+            fprintf(out_fp, "%s\t%d\t.\t%c%.*s\t%c%.*s\t%f\tPASS\t.\tGT\t%s\n", 
+                    ctg_dict.name(ctg).data(), pos+1, ref_base, 
+                    int(ref.size()), ref.data(), 
+                    ref_base, int(alt.size()), alt.data(), qual, gt.data());
         } catch (const std::out_of_range & e) {
-            ERROR("Contig '%s' not in reference FASTA (print_variant)", ctg.data());
+            ERROR("Contig '%s' not in reference FASTA (print_variant)", 
+                    ctg_dict.name(ctg).data());
         }
         break;
     default:
@@ -287,76 +412,597 @@ void variantData::print_variant(FILE* out_fp, std::string ctg, int pos, int type
 void variantData::set_header(const std::shared_ptr<variantData> vcf) {
     this->filename = vcf->filename;
     this->sample = vcf->sample;
+    this->callset = vcf->callset;
     this->contigs = vcf->contigs;
     this->lengths = vcf->lengths;
     this->ploidy = vcf->ploidy;
     this->ref = vcf->ref;
-    for (std::string ctg : this->contigs)
-        for (int hap = 0; hap < 2; hap++)
+    for (int ctg : this->contigs)
+        this->init_ctg(ctg);
+}
+
+
+/* Move contigs `ctgs` into a new `variantData` with the same header, so that
+ * they can be evaluated (and then freed) separately from the other contigs.
+ */
+std::shared_ptr<variantData> variantData::take_contigs(
+        const std::vector<int> & ctgs) {
+    std::shared_ptr<variantData> window(new variantData());
+    window->filename = this->filename;
+    window->sample = this->sample;
+    window->callset = this->callset;
+    window->ref = this->ref;
+    for (int i = 0; i < int(this->contigs.size()); i++) {
+        int ctg = this->contigs[i];
+        if (std::find(ctgs.begin(), ctgs.end(), ctg) == ctgs.end()) continue;
+        window->contigs.push_back(ctg);
+        window->lengths.push_back(this->lengths[i]);
+        window->ploidy.push_back(this->ploidy[i]);
+        window->init_ctg(ctg);
+        for (int hap = 0; hap < HAPS; hap++)
+            std::swap(window->ctg_variants[hap][ctg], this->ctg_variants[hap][ctg]);
+    }
+    return window;
+}
+
+
+/* Create empty variant lists for contig `ctg`, if not yet present. */
+void variantData::init_ctg(int ctg) {
+    for (int hap = 0; hap < HAPS; hap++) {
+        if (ctg >= int(this->ctg_variants[hap].size()))
+            this->ctg_variants[hap].resize(ctg+1, nullptr);
+        if (this->ctg_variants[hap][ctg] == nullptr)
             this->ctg_variants[hap][ctg] = 
                 std::shared_ptr<ctgVariants>(new ctgVariants());
+    }
 }
 
 
-/* Copy variants from `cigar` string to `variantData`. */
-void variantData::add_variants(
-        const std::vector<int> & cigar, 
-        int hap, int ref_pos,
-        const std::string & ctg, 
-        const std::string & query, 
-        const std::string & ref, 
-        int qual) {
+/******************************************************************************/
 
-    int query_idx = 0;
-    int ref_idx = 0;
-    for (size_t cig_idx = 0; cig_idx < cigar.size(); ) {
-        int indel_len = 0;
-        switch (cigar[cig_idx]) {
+vcfSample::vcfSample() : prev_end(2, 0), 
+        ntypes(2, std::vector<int>(type_strs.size(), 0)), npass(2, 0),
+        ngts(gt_strs.size(), 0), nregions(region_strs.size(), 0) { ; }
 
-            case PTR_MAT: // no variant, update pointers
-                cig_idx += 2;
-                ref_idx++;
-                query_idx++;
+void vcfSample::add_counts(const vcfSample & other) {
+    for (int h = 0; h < HAPS; h++) {
+        this->npass[h] += other.npass[h];
+        for (size_t i = 0; i < type_strs.size(); i++)
+            this->ntypes[h][i] += other.ntypes[h][i];
+    }
+    for (size_t i = 0; i < gt_strs.size(); i++)
+        this->ngts[i] += other.ngts[i];
+    for (size_t i = 0; i < region_strs.size(); i++)
+        this->nregions[i] += other.nregions[i];
+    this->overlapping_var_total += other.overlapping_var_total;
+    this->unknown_allele_total += other.unknown_allele_total;
+    this->small_var_total += other.small_var_total;
+    this->large_var_total += other.large_var_total;
+    this->wrong_ploidy_total += other.wrong_ploidy_total;
+}
+
+/******************************************************************************/
+
+vcfParser::vcfParser(bcf_hdr_t * hdr, int callset, int pass_filter_id) : 
+        pass_min_qual(2, 0) {
+    this->hdr = hdr;
+    this->callset = callset;
+    this->pass_filter_id = pass_filter_id;
+    this->nsamples = bcf_hdr_nsamples(hdr);
+    this->samples.resize(this->nsamples);
+    this->gqs.resize(this->nsamples, 0);
+}
+
+vcfParser::~vcfParser() {
+    free(this->gq);
+    free(this->fgq);
+    free(this->gt);
+}
+
+/* Point each sample's context at its variants on a new contig. */
+void vcfParser::start_ctg(const std::vector< std::shared_ptr<variantData> > & vcfs,
+        int ctg, const std::vector<int*> & ploidy) {
+    for (int s = 0; s < this->nsamples; s++) {
+        this->samples[s].vars = { vcfs[s]->ctg_variants[HAP1].at(ctg), 
+                                  vcfs[s]->ctg_variants[HAP2].at(ctg) };
+        this->samples[s].ploidy = ploidy[s];
+        this->samples[s].prev_end = {-g.cluster_min_gap*2, -g.cluster_min_gap*2};
+        bedCursor bed = g.bed.cursor(ctg_dict.name(ctg));
+        this->samples[s].bed = {bed, bed};
+    }
+}
+
+void vcfParser::add_counts(const vcfParser & other) {
+    this->n += other.n;
+    this->pass_min_qual[FAIL] += other.pass_min_qual[FAIL];
+    this->pass_min_qual[PASS] += other.pass_min_qual[PASS];
+    for (int s = 0; s < this->nsamples; s++)
+        this->samples[s].add_counts(other.samples[s]);
+}
+
+/* Filter a single VCF record, decode its FORMAT fields once, and add its 
+ * alleles to each sample's haplotypes.
+ */
+void vcfParser::parse_record(bcf1_t * rec, const std::string & ctg) {
+
+    // unpack alleles and filters only, INFO is unused and FORMAT is unpacked
+    // when GQ/GT are requested (after filtering)
+    bcf_unpack(rec, BCF_UN_FLT);
+    this->n++;
+
+    // check that variant passed all filters
+    bool pass = false;
+    for (int i = 0; i < rec->d.n_flt; i++) {
+        if (rec->d.flt[i] == this->pass_filter_id) pass = true;
+    }
+    if (rec->d.n_flt == 0) pass = true; // allow if no other filters
+    if (!pass) return;
+
+    // check that variant exceeds min_qual
+    float vq = rec->qual;
+    if (std::isnan(vq)) vq = 0; // no quality reported (.)
+    pass = vq >= g.min_qual;
+    this->pass_min_qual[pass]++;
+    if (!pass) return;
+
+    // parse GQ in either INT or FLOAT format
+    int ngq = 0;
+    if (this->int_qual) {
+        ngq = bcf_get_format_int32(this->hdr, rec, "GQ", &this->gq, &this->ngq_arr);
+        if (ngq == -2) {
+            ngq = bcf_get_format_float(this->hdr, rec, "GQ", &this->fgq, &this->nfgq_arr);
+            this->int_qual = false;
+        }
+    }
+    else {
+        ngq = bcf_get_format_float(this->hdr, rec, "GQ", &this->fgq, &this->nfgq_arr);
+    }
+    if (ngq >= this->nsamples) {
+        for (int s = 0; s < this->nsamples; s++)
+            this->gqs[s] = this->int_qual ? this->gq[s] : int(this->fgq[s]);
+    } else if ( ngq == -3 ) {
+        /* if (g.verbosity > 1 || !gq_missing_total) */
+        /*     WARN("No GQ tag in %s VCF at %s:%lld", */
+        /*             callset_strs[callset].data(), ctg.data(), (long long)rec->pos); */
+        /* gq_missing_total++; // only warn once */
+        std::fill(this->gqs.begin(), this->gqs.end(), 0);
+    }
+
+    // parse GT
+    int ngt = bcf_get_format_int32(this->hdr, rec, "GT", &this->gt, &this->ngt_arr);
+    if (ngt == -1) { // GT not defined in header
+        if (!this->gt_warn) {
+            this->gt_warn = true;
+            WARN("'GT' tag not defined in header, assuming monoploid");
+        }
+    } else if (ngt < 0) { // other error
+        ERROR("Failed to read %s GT at %s:%lld", 
+                callset_strs[callset].data(), ctg.data(), (long long)rec->pos);
+    }
+
+    // split GT among samples, each padded to the maximum ploidy
+    int max_ngt = ngt < 0 ? ngt : ngt / this->nsamples;
+    for (int s = 0; s < this->nsamples; s++) {
+        const int * sample_gt = ngt < 0 ? NULL : this->gt + s*max_ngt;
+        int sample_ngt = max_ngt;
+        if (max_ngt > 0) { // haploid sample among diploid samples
+            sample_ngt = 0;
+            while (sample_ngt < max_ngt && 
+                    sample_gt[sample_ngt] != bcf_int32_vector_end) sample_ngt++;
+        }
+        this->parse_sample(rec, ctg, s, sample_gt, sample_ngt, vq);
+    }
+}
+
+/* Add the alleles of one sample's genotype to its haplotypes. */
+void vcfParser::parse_sample(bcf1_t * rec, const std::string & ctg, int s,
+        const int * gt, int ngt, float vq) {
+    vcfSample & smp = this->samples[s];
+    int & ploidy = *smp.ploidy;
+
+    // update ploidy info
+    if (ploidy != 0) { // already set, enforce it doesn't change
+        if (std::abs(ngt) != ploidy && ctg[ctg.size()-1] != 'X') {
+            if (g.verbosity > 1)
+                WARN("Expected ploidy %d for all variants on contig '%s',"
+                      " found ploidy %d at %s:%lld in %s VCF.", ploidy,
+                    ctg.data(), std::abs(ngt), ctg.data(), (long long)rec->pos,
+                    callset_strs[callset].data());
+            smp.wrong_ploidy_total += 1;
+        }
+    } else { // set ploidy for this contig
+        ploidy = std::abs(ngt);
+    }
+
+    // parse genotype info
+    int orig_gt = GT_REF_REF;
+    bool same = false;
+    if (ngt == -1) { // no info, assume monoploid
+        orig_gt = GT_ALT1;
+    } else if (ngt == 1) { // monoploid/haploid
+
+        // set 1 if allele_idx > 0
+        orig_gt = bcf_gt_allele(gt[0]) ? GT_ALT1 : GT_REF;
+
+    } else if (ngt == 2) { // diploid
+
+        // missing, ignore
+        if (bcf_gt_is_missing(gt[0]) || bcf_gt_is_missing(gt[1])) {
+            orig_gt = GT_MISSING;
+
+        } else { // useful
+
+            // allow setting N/N to 1/1 later
+            if (bcf_gt_allele(gt[0]) == bcf_gt_allele(gt[1])) same = true;
+
+            if (bcf_gt_allele(gt[0]) == 0) { // REF
+                switch (bcf_gt_allele(gt[1])) {
+                    case 0: orig_gt = GT_REF_REF; break;
+                    case 1: orig_gt = GT_REF_ALT1; break;
+                    default: orig_gt = GT_OTHER; break;
+                }
+            } else if (bcf_gt_allele(gt[0]) == 1) { // ALT1
+                switch (bcf_gt_allele(gt[1])) {
+                    case 0: orig_gt = GT_ALT1_REF; break;
+                    case 1: orig_gt = GT_ALT1_ALT1; break;
+                    case 2: orig_gt = GT_ALT1_ALT2; break;
+                    default: orig_gt = GT_OTHER; break;
+                }
+            } else if (bcf_gt_allele(gt[0]) == 2) { // ALT2
+                orig_gt = (bcf_gt_allele(gt[1]) == 1) ? GT_ALT2_ALT1 : GT_OTHER;
+            } else {
+                orig_gt = GT_OTHER;
+            }
+        }
+
+    } else if (ngt > 2) { // polyploid
+        ERROR("Expected monoploid/diploid %s VCF, found variant with ploidy %d",
+                callset_strs[callset].data(), ngt);
+    }
+    smp.ngts[orig_gt]++;
+
+    // parse variant type
+    /* bool counted_unphased = false; */
+    for (int hap = 0; hap < std::abs(ngt); hap++) { // allow single-allele chrX, chrY
+
+        // set simplified GT (0|1, 1|0, or 1|1), (0|0 and .|. skipped later)
+        int simple_gt = hap ? GT_REF_ALT1 : GT_ALT1_REF; // 0|1 or 1|0 default
+        if (same) simple_gt = GT_ALT1_ALT1; // overwrite 1|1 if both agree
+
+        // get ref and allele, skipping ref query
+        std::string_view ref = rec->d.allele[0];
+        int alt_idx = ngt < 0 ? 1 : bcf_gt_allele(gt[hap]); // if no GT, assume 1
+        if (alt_idx < 0) {
+            if (g.verbosity > 1)
+                WARN("Unknown allele (.) in %s VCF at %s:%lld, skipping",
+                    callset_strs[callset].data(), ctg.data(), (long long)rec->pos);
+            smp.unknown_allele_total += 1;
+            continue;
+        }
+        if (alt_idx == 0) continue; // nothing to do if reference
+        std::string_view alt = rec->d.allele[alt_idx];
+
+        /* // count unphased variants (once per potentially diploid variant) */
+        /* if (!counted_unphased && !bcf_gt_is_phased(gt[hap])) { */
+        /*     if (g.verbosity > 1) */
+        /*         WARN("Unphased genotype in %s VCF at %s:%lld", */
+        /*             callset_strs[callset].data(), ctg.data(), (long long)rec->pos); */
+        /*     unphased_gt_total += 1; */
+        /*     counted_unphased = true; */
+        /* } */
+
+        // skip spanning deletion
+        if (alt == "*") { smp.ntypes[hap][TYPE_REF]++; continue; }
+
+        // determine variant type
+        int pos = rec->pos;
+        int type = -1;
+        int lm = 0; // match from left->right (trim prefix)
+        int rm = -1;// match from right->left (simplify complex variants CPX->INDEL)
+        int reflen = int(ref.size());
+        int altlen = int(alt.size());
+        if (altlen-reflen > 0) { // insertion
+            while (lm < reflen && ref[lm] == alt[lm]) lm++;
+            while (reflen+rm >= lm && 
+                    ref[reflen+rm] == alt[altlen+rm]) rm--;
+            if (lm > reflen+rm) type = TYPE_INS; else type = TYPE_CPX;
+            pos += lm;
+            alt = alt.substr(lm, altlen+rm-lm+1);
+            ref = ref.substr(lm, reflen+rm-lm+1);
+
+        } else if (altlen-reflen < 0) { // deletion
+            while (lm < altlen && ref[lm] == alt[lm]) lm++;
+            while (altlen+rm >= lm && 
+                    ref[reflen+rm] == alt[altlen+rm]) rm--;
+            if (lm > altlen+rm) type = TYPE_DEL; else type = TYPE_CPX;
+            pos += lm;
+            alt = alt.substr(lm, altlen+rm-lm+1);
+            ref = ref.substr(lm, reflen+rm-lm+1);
+
+        } else { // substitution
+            if (ref.size() == 1) {
+                type = (ref[0] == alt[0] ? TYPE_REF : TYPE_SUB);
+                if (type == TYPE_REF) continue;
+            } else {
+                if (ref.substr(1) == alt.substr(1)){
+                    type = TYPE_SUB;
+                    ref = ref.substr(0, 1); alt = alt.substr(0, 1); // chop off matches
+                }
+                else type = TYPE_CPX;
+            }
+        }
+
+        // calculate reference length of variant
+        int rlen = 0;
+        switch (type) {
+            case TYPE_INS:
+                rlen = 0; break;
+            case TYPE_SUB:
+            case TYPE_REF:
+                rlen = 1; break;
+            case TYPE_DEL:
+            case TYPE_CPX:
+                rlen = ref.size(); break;
+            default:
+                ERROR("Unexpected variant type: %d", type);
                 break;
+        }
 
-            case PTR_SUB: // substitution
-                cig_idx += 2;
-                this->ctg_variants[hap][ctg]->add_var(ref_pos+ref_idx, 1, hap, 
-                        TYPE_SUB, BED_INSIDE, std::string(1,ref[ref_idx]), 
-                        std::string(1,query[query_idx]), 
-                        GT_REF_REF, g.max_qual, qual);
-                ref_idx++;
-                query_idx++;
+        // check that variant is in region of interest
+        uint8_t loc = smp.bed[hap].contains(pos, pos + rlen);
+        switch (loc) {
+            case BED_OUTSIDE: 
+            case BED_OFFCTG:
+                smp.nregions[loc]++;
+                continue; // discard variant
+            case BED_INSIDE: 
+            case BED_BORDER:
+                smp.nregions[loc]++;
+                break;
+            default:
+                ERROR("Unexpected BED region type: %d", loc);
                 break;
+        }
 
-            case PTR_DEL: // deletion
-                cig_idx++; indel_len++;
+        // skip variants that are too small or large
+        if (int(ref.size()) > g.max_size || int(alt.size()) > g.max_size) {
+            if (g.verbosity > 1)
+                WARN("Large variant of length %d in %s VCF at %s:%lld, skipping",
+                    int(std::max(ref.size(), alt.size())),
+                    callset_strs[callset].data(), ctg.data(), (long long)rec->pos);
+            smp.large_var_total++;
+            continue;
+        }
+        if (int(ref.size()) < g.min_size && int(alt.size()) < g.min_size) {
+            if (g.verbosity > 1)
+                WARN("Small variant of length %d in %s VCF at %s:%lld, skipping",
+                    int(std::max(ref.size(), alt.size())),
+                    callset_strs[callset].data(), ctg.data(), (long long)rec->pos);
+            smp.small_var_total++;
+            continue;
+        }
 
-                // multi-base deletion
-                while (cig_idx < cigar.size() && cigar[cig_idx] == PTR_DEL) {
-                    cig_idx++; indel_len++;
+        // TODO: keep overlaps, test all non-overlapping subsets?
+        // skip overlapping variants
+        if (smp.prev_end[hap] > pos) { // warn if overlap
+            if (g.verbosity > 1) {
+                WARN("Overlap in %s VCF variants at %s:%i, skipping", 
+                        callset_strs[callset].data(), ctg.data(), pos);
+            }
+            smp.overlapping_var_total++;
+            continue;
+        }
+
+        // add to haplotype-specific query info
+        if (type == TYPE_CPX) { // split CPX into INS+DEL
+            smp.vars[hap]->add_var(pos, 0, // INS
+                hap, TYPE_INS, loc, "", alt, simple_gt, this->gqs[s], vq);
+            smp.vars[hap]->add_var(pos, rlen, // DEL
+                hap, TYPE_DEL, loc, ref, "", simple_gt, this->gqs[s], vq);
+        } else {
+            smp.vars[hap]->add_var(pos, rlen,
+                    hap, type, loc, ref, alt, simple_gt, this->gqs[s], vq);
+        }
+
+        smp.prev_end[hap] = pos + rlen;
+        smp.npass[hap]++;
+        smp.ntypes[hap][type]++;
+    }
+}
+
+/******************************************************************************/
+
+/* Parse every `nthreads`-th contig of an indexed VCF, starting at `thread_id`.
+ * Each thread uses its own file handle, header, and record parser.
+ */
+void parse_ctgs_indexed(const std::vector< std::shared_ptr<variantData> > & vcfs,
+        hts_idx_t * idx, tbx_t * tbx, int pass_filter_id, 
+        const std::vector<int> & ctg_ids, const std::vector<int> & rids, bool probe,
+        int thread_id, int nthreads, 
+        std::vector< std::vector<int> > * ctg_ploidy, std::vector<int> * ctg_nrecs,
+        std::shared_ptr<vcfParser> * counts) {
+
+    const std::string & vcf_fn = vcfs[0]->filename;
+    int callset = vcfs[0]->callset;
+    htsFile* vcf = bcf_open(vcf_fn.data(), "r");
+    if (g.io_pool.pool != NULL)
+        hts_set_opt(vcf, HTS_OPT_THREAD_POOL, &g.io_pool);
+    bcf_hdr_t * hdr = bcf_hdr_read(vcf);
+    bcf1_t * rec = bcf_init();
+    kstring_t str = {0, 0, NULL};
+    *counts = std::shared_ptr<vcfParser>(
+            new vcfParser(hdr, callset, pass_filter_id));
+    vcfParser & parser = **counts;
+    std::vector<int*> ploidy(parser.nsamples);
+
+    int nctg = 0;
+    const char **ctgnames = bcf_hdr_seqnames(hdr, &nctg);
+    for (int j = thread_id; j < int(rids.size()); j += nthreads) {
+        int i = rids[j];
+        std::string ctg = ctgnames[i];
+
+        int tid = tbx != NULL ? tbx_name2id(tbx, ctg.data()) : i;
+        if (tid < 0) continue; // no records on contig
+
+        // query entire contig, or only BED regions padded by supercluster gap
+        std::vector<hts_pos_t> begs = {0};
+        std::vector<hts_pos_t> ends = {HTS_POS_MAX};
+        if (g.bed_exists) {
+            auto regions_itr = g.bed.regions.find(ctg);
+            if (regions_itr == g.bed.regions.end()) continue; // all OFFCTG
+            const contigRegions & regions = regions_itr->second;
+            begs.clear(); ends.clear();
+            for (int r = 0; r < regions.n; r++) {
+                hts_pos_t beg = std::max(0, regions.starts[r] - g.cluster_min_gap);
+                hts_pos_t end = regions.stops[r] + g.cluster_min_gap;
+                if (ends.size() && beg <= ends.back()) { // merge padded regions
+                    ends.back() = std::max(ends.back(), end);
+                } else {
+                    begs.push_back(beg);
+                    ends.push_back(end);
                 }
-                this->ctg_variants[hap][ctg]->add_var(ref_pos+ref_idx,
-                        indel_len, hap, TYPE_DEL, BED_INSIDE,
-                        ref.substr(ref_idx, indel_len),
-                        "", GT_REF_REF, g.max_qual, qual);
-                ref_idx += indel_len;
-                break;
+            }
+        }
 
-            case PTR_INS: // insertion
-                cig_idx++; indel_len++;
+        for (int smp = 0; smp < parser.nsamples; smp++)
+            ploidy[smp] = &(*ctg_ploidy)[smp][i];
+        parser.start_ctg(vcfs, ctg_ids[i], ploidy);
+        bool done = false;
+        for (size_t r = 0; !done && r < begs.size(); r++) {
+            hts_itr_t * itr = tbx != NULL ? 
+                    tbx_itr_queryi(tbx, tid, begs[r], ends[r]) :
+                    bcf_itr_queryi(idx, tid, begs[r], ends[r]);
+            if (itr == NULL) continue;
+
+            while ((tbx != NULL ? tbx_itr_next(vcf, tbx, itr, &str) : 
+                        bcf_itr_next(vcf, itr, rec)) >= 0) {
+                if (tbx != NULL && vcf_parse(&str, hdr, rec) < 0)
+                    ERROR("Failed to parse %s VCF '%s' record on contig '%s'",
+                            callset_strs[callset].data(), vcf_fn.data(), ctg.data());
+
+                // skip records overlapping previous region, already parsed
+                if (r > 0 && rec->pos < ends[r-1]) continue;
+
+                (*ctg_nrecs)[i]++;
+                parser.parse_record(rec, ctg);
+
+                // probing only needs each sample's ploidy
+                if (probe && std::none_of(ploidy.begin(), ploidy.end(), 
+                            [](int * p) { return *p == 0; })) {
+                    done = true;
+                    break;
+                }
+            }
+            hts_itr_destroy(itr);
+        }
 
-                // multi-base insertion
-                while (cig_idx < cigar.size() && cigar[cig_idx] == PTR_INS) {
-                    cig_idx++; indel_len++;
+        // discard probed variants, parsed again by read_vcf_window()
+        if (probe) {
+            for (int smp = 0; smp < parser.nsamples; smp++)
+                for (int hap = 0; hap < HAPS; hap++)
+                    vcfs[smp]->ctg_variants[hap][ctg_ids[i]] = 
+                        std::shared_ptr<ctgVariants>(new ctgVariants());
+        }
+    }
+
+    parser.hdr = NULL;
+    free(str.s);
+    free(ctgnames);
+    bcf_destroy(rec);
+    bcf_hdr_destroy(hdr);
+    bcf_close(vcf);
+}
+
+/******************************************************************************/
+
+/* Print filtering statistics for sample `s` after parsing a VCF. Locked, since
+ * the query and truth VCFs may be parsed concurrently.
+ */
+void variantData::print_summary(const vcfParser & parser, int s) {
+    std::lock_guard<std::mutex> lock(summary_mutex);
+    const vcfSample & smp = parser.samples[s];
+
+    if (parser.nsamples > 1 && g.verbosity >= 1) {
+        INFO(" ");
+        INFO("  %s VCF sample '%s':", callset_strs[this->callset].data(), 
+                this->sample.data());
+    }
+
+    /* if (gq_missing_total) */ 
+    /*     WARN("%d total missing GQ tags in %s VCF, all considered GQ=0", */
+    /*         gq_missing_total, callset_strs[this->callset].data()); */
+
+    if (smp.unknown_allele_total) 
+        WARN("%d total unknown alleles (.) found in %s VCF, skipped",
+            smp.unknown_allele_total, callset_strs[this->callset].data());
+
+    if (smp.wrong_ploidy_total) 
+        WARN("%d total variants with incorrect ploidy found in %s VCF, kept",
+            smp.wrong_ploidy_total, callset_strs[this->callset].data());
+
+    /* if (unphased_gt_total) */ 
+    /*     WARN("%d total unphased genotypes found in %s VCF", */
+    /*         unphased_gt_total, callset_strs[this->callset].data()); */
+
+    if (smp.large_var_total)
+        WARN("%d total large %s VCF variant calls skipped, size > %d", 
+                smp.large_var_total, callset_strs[this->callset].data(), g.max_size);
+
+    if (smp.small_var_total)
+        WARN("%d total small %s VCF variant calls skipped, size < %d", 
+                smp.small_var_total, callset_strs[this->callset].data(), g.min_size);
+
+    if (smp.overlapping_var_total)
+        WARN("%d total overlapping %s VCF variant calls skipped", 
+                smp.overlapping_var_total, callset_strs[this->callset].data());
+
+    if (g.verbosity >= 1) {
+        INFO("  Contigs:");
+        for (size_t i = 0; i < this->contigs.size(); i++) {
+            INFO("    [%2lu] %s: %d | %d variants", i, 
+                    ctg_dict.name(this->contigs[i]).data(),
+                    this->ctg_variants[HAP1][this->contigs[i]]->n, 
+                    this->ctg_variants[HAP2][this->contigs[i]]->n);
+        }
+        INFO(" ");
+
+        INFO("  Genotypes:");
+        for (size_t i = 0; i < gt_strs.size(); i++) {
+            INFO("    %3s  %i", gt_strs[i].data(), smp.ngts[i]);
+        }
+        INFO(" ");
+
+        INFO("  Variant exceeds min qual (%d):", g.min_qual);
+        INFO("    FAIL  %d", parser.pass_min_qual[FAIL]);
+        INFO("    PASS  %d", parser.pass_min_qual[PASS]);
+        INFO(" ");
+
+        INFO("  Variants in BED regions:");
+        for (size_t i = 0; i < region_strs.size(); i++) {
+            INFO("    %s  %i", region_strs[i].data(), smp.nregions[i]);
+        }
+        INFO(" ");
+
+        INFO("  Variant types:");
+        if (g.verbosity >= 2) { // show each hap separately
+            for (int h = 0; h < HAPS; h++) {
+                INFO("    Haplotype %i", h+1);
+                for (size_t i = 0; i < type_strs.size(); i++) {
+                    INFO("      %s  %i", type_strs[i].data(), smp.ntypes[h][i]);
                 }
-                this->ctg_variants[hap][ctg]->add_var(ref_pos+ref_idx,
-                        0, hap, TYPE_INS, BED_INSIDE, "", 
-                        query.substr(query_idx, indel_len), 
-                        GT_REF_REF, g.max_qual, qual);
-                query_idx += indel_len;
-                break;
+            }
+            INFO(" ");
+        } else { // summarize
+            for (size_t i = 0; i < type_strs.size(); i++) {
+                INFO("    %s  %i", type_strs[i].data(), 
+                        smp.ntypes[HAP1][i] + smp.ntypes[HAP2][i]);
+            }
         }
+        INFO(" ");
+
+        INFO("  %s VCF overview:", callset_strs[this->callset].data());
+        INFO("    TOTAL %d", parser.n);
+        INFO("    KEPT  %d", smp.npass[HAP1] + smp.npass[HAP2]);
     }
 }
 
@@ -364,67 +1010,54 @@ void variantData::add_variants(
 
 variantData::variantData() : ctg_variants(2) { ; }
 
-variantData::variantData(std::string vcf_fn, 
-        std::shared_ptr<fastaData> reference, 
-        int callset) : ctg_variants(2) {
+/* Read the sample names from a VCF header, without parsing any records. */
+std::vector<std::string> read_vcf_samples(const std::string & vcf_fn, int callset) {
+    htsFile* vcf = bcf_open(vcf_fn.data(), "r");
+    if (vcf == NULL) ERROR("Failed to open %s VCF '%s'", 
+            callset_strs[callset].data(), vcf_fn.data());
+    bcf_hdr_t * hdr = bcf_hdr_read(vcf);
+    if (hdr == NULL) ERROR("Failed to read %s VCF '%s' header", 
+            callset_strs[callset].data(), vcf_fn.data());
+    std::vector<std::string> samples;
+    for (int s = 0; s < bcf_hdr_nsamples(hdr); s++)
+        samples.push_back(hdr->samples[s]);
+    bcf_hdr_destroy(hdr);
+    bcf_close(vcf);
+    return samples;
+}
 
-    // set reference fasta pointer
-    this->ref = reference;
-    this->filename = vcf_fn;
+/* Parse a VCF in a single pass, returning one variantData per sample. All
+ * samples share the record decoding; each keeps its own variants and counts.
+ */
+std::vector< std::shared_ptr<variantData> > read_vcf(std::string vcf_fn, 
+        std::shared_ptr<fastaData> reference, int callset) {
 
     if (callset < 0 || callset >= CALLSETS)
         ERROR("Invalid callset (%d).", callset);
-    this->callset = callset;
+    std::vector< std::shared_ptr<variantData> > vcfs;
 
     if (g.verbosity >= 1) INFO(" ");
     if (g.verbosity >= 1) INFO("%s[%s 0/8] Parsing %s VCF%s '%s'", COLOR_PURPLE,
             callset == QUERY ? "Q" : "T", callset_strs[callset].data(), 
             COLOR_WHITE, vcf_fn.data());
     htsFile* vcf = bcf_open(vcf_fn.data(), "r");
-
-    // counters
-    int nctg   = 0;                     // number of ctgs
-    std::vector< std::vector<int> > 
-        ntypes(2, std::vector<int>(type_strs.size(), 0));
-    int n      = 0;                     // total number of records in file
-    std::vector<int> npass  = {0, 0};   // records PASSing all filters
-
-    // data
-    std::vector<int> prev_end = {-g.cluster_min_gap*2, -g.cluster_min_gap*2};
+    if (g.io_pool.pool != NULL)
+        hts_set_opt(vcf, HTS_OPT_THREAD_POOL, &g.io_pool);
+    int nctg = 0;                       // number of ctgs
     std::unordered_map<int, bool> prev_rids;
     int prev_rid = -1;
     std::unordered_map<int, int> ctglens;
     std::string ctg;
-    std::vector<int> nregions(region_strs.size(), 0);
-    std::vector<int> pass_min_qual = {0, 0};
-
-    // quality data for each call
-    int ngq_arr = 0;
-    int ngq     = 0;
-    int * gq    = (int*) malloc(sizeof(int));
-    float * fgq = (float*) malloc(sizeof(float));
-    bool int_qual = true;
-
-    // genotype data for each call
-    int ngt_arr   = 0;
-    int ngt       = 0;
-    std::vector<int> ngts(gt_strs.size(), 0);
-    int * gt      = NULL;
-    bool gt_warn  = false;
-
-    /* int gq_missing_total = 0; */
-    int overlapping_var_total = 0;
-    int unknown_allele_total = 0;
-    /* int unphased_gt_total = 0; */
-    int small_var_total = 0;
-    int large_var_total = 0;
-    int wrong_ploidy_total = 0;
+    std::vector<int> ctg_ids;           // contig dictionary IDs, by rid
+    hts_idx_t * idx = NULL;
+    tbx_t * tbx = NULL;
+    std::vector<int*> ploidy;
+    bool defer = false;
     
     // read header
     bcf1_t * rec  = NULL;
     bcf_hdr_t *hdr = bcf_hdr_read(vcf);
     int pass_filter_id = 0;
-    bool pass = false;
     bool pass_found = false;
     for (int i = 0; i < hdr->nhrec; i++) {
 
@@ -478,10 +1111,20 @@ variantData::variantData(std::string vcf_fn,
     if (!pass_found)
         ERROR("Failed to find PASS FILTER index in %s VCF '%s'",
                 callset_strs[callset].data(), vcf_fn.data());
-    if (bcf_hdr_nsamples(hdr) != 1) 
-        ERROR("Expected 1 sample but found %d in %s VCF '%s'", bcf_hdr_nsamples(hdr),
-                callset_strs[callset].data(), vcf_fn.data());
-    this->sample = hdr->samples[0];
+    if (bcf_hdr_nsamples(hdr) < 1) 
+        ERROR("Expected at least 1 sample but found %d in %s VCF '%s'", 
+                bcf_hdr_nsamples(hdr), callset_strs[callset].data(), vcf_fn.data());
+    for (int s = 0; s < bcf_hdr_nsamples(hdr); s++) {
+        std::shared_ptr<variantData> vcf_ptr(new variantData());
+        vcf_ptr->ref = reference;
+        vcf_ptr->filename = vcf_fn;
+        vcf_ptr->callset = callset;
+        vcf_ptr->sample = hdr->samples[s];
+        vcfs.push_back(vcf_ptr);
+    }
+
+    vcfParser parser(hdr, callset, pass_filter_id);
+    ploidy.resize(parser.nsamples);
 
     // report names of all the ctgs in the VCF file
     const char **ctgnames = NULL;
@@ -491,11 +1134,10 @@ variantData::variantData(std::string vcf_fn,
                 callset_strs[callset].data(), vcf_fn.data());
         goto error1;
     }
+    ctg_ids.resize(nctg);
     for(int i = 0; i < nctg; i++) {
-        this->ctg_variants[HAP1][ctgnames[i]] = 
-                std::shared_ptr<ctgVariants>(new ctgVariants());
-        this->ctg_variants[HAP2][ctgnames[i]] = 
-                std::shared_ptr<ctgVariants>(new ctgVariants());
+        ctg_ids[i] = ctg_dict.id(ctgnames[i]);
+        for (auto & vcf_ptr : vcfs) vcf_ptr->init_ctg(ctg_ids[i]);
     }
 
     // struct for storing each record
@@ -505,377 +1147,179 @@ variantData::variantData(std::string vcf_fn,
                 callset_strs[callset].data(), vcf_fn.data());
         goto error2;
     }
-    
-    while (bcf_read(vcf, hdr, rec) == 0) {
-
-        ctg = ctgnames[rec->rid];
-        if (rec->rid != prev_rid) {
 
-            // start new contig
-            prev_rid = rec->rid;
-            if (prev_rids.find(rec->rid) != prev_rids.end()) {
-                ERROR("Unsorted %s VCF '%s', contig '%s' already parsed", 
-                        callset_strs[callset].data(), vcf_fn.data(), ctg.data());
-            } else {
-                this->contigs.push_back(ctg);
-                this->ploidy.push_back(0);
-                this->lengths.push_back(ctglens[rec->rid]);
-                prev_end = {-g.cluster_min_gap*2, -g.cluster_min_gap*2};
-            }
-        }
-
-        // unpack info (populates rec->d allele info)
-        bcf_unpack(rec, BCF_UN_ALL);
-        n++;
-
-        // check that variant passed all filters
-        pass = false;
-        for (int i = 0; i < rec->d.n_flt; i++) {
-            if (rec->d.flt[i] == pass_filter_id) pass = true;
+    // parse contigs in parallel if the VCF is indexed
+    if (hts_get_format(vcf)->format == bcf)
+        idx = bcf_index_load3(vcf_fn.data(), NULL, HTS_IDX_SILENT_FAIL);
+    else if (hts_get_format(vcf)->compression == bgzf)
+        tbx = tbx_index_load3(vcf_fn.data(), NULL, HTS_IDX_SILENT_FAIL);
+    if (idx != NULL || tbx != NULL) {
+
+        // when evaluating contig windows, only probe each contig for records
+        // and ploidy here, deferring the rest to read_vcf_window()
+        defer = g.contig_window > 0;
+        std::vector<int> rids(nctg);
+        for (int i = 0; i < nctg; i++) rids[i] = i;
+        int nthreads = std::max(1, std::min(g.max_threads, nctg));
+        std::vector< std::vector<int> > ctg_ploidy(
+                parser.nsamples, std::vector<int>(nctg, 0));
+        std::vector<int> ctg_nrecs(nctg, 0);
+        std::vector< std::shared_ptr<vcfParser> > thread_counts(nthreads);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nthreads; t++) {
+            threads.push_back(std::thread(parse_ctgs_indexed, std::cref(vcfs),
+                        idx, tbx, pass_filter_id, std::cref(ctg_ids), std::cref(rids),
+                        defer, t, nthreads, &ctg_ploidy, &ctg_nrecs, &thread_counts[t]));
         }
-        if (rec->d.n_flt == 0) pass = true; // allow if no other filters
-        if (!pass) continue;
-
-        // check that variant exceeds min_qual
-        float vq = rec->qual;
-        if (std::isnan(vq)) vq = 0; // no quality reported (.)
-        pass = vq >= g.min_qual;
-        pass_min_qual[pass]++;
-        if (!pass) continue;
-
-        // parse GQ in either INT or FLOAT format
-        if (int_qual) {
-            ngq = bcf_get_format_int32(hdr, rec, "GQ", &gq, &ngq_arr);
-            if (ngq == -2) {
-                ngq = bcf_get_format_float(hdr, rec, "GQ", &fgq, &ngq_arr);
-                gq[0] = int(fgq[0]);
-                int_qual = false;
+        for (auto & t : threads)
+            t.join();
+
+        // merge results in header order
+        for (int i = 0; i < nctg; i++) {
+            if (ctg_nrecs[i] == 0) continue;
+            for (int s = 0; s < parser.nsamples; s++) {
+                vcfs[s]->contigs.push_back(ctg_ids[i]);
+                vcfs[s]->ploidy.push_back(ctg_ploidy[s][i]);
+                vcfs[s]->lengths.push_back(ctglens[i]);
             }
         }
-        else {
-            ngq = bcf_get_format_float(hdr, rec, "GQ", &fgq, &ngq_arr);
-            gq[0] = int(fgq[0]);
-        }
-        if ( ngq == -3 ) {
-            /* if (g.verbosity > 1 || !gq_missing_total) */
-            /*     WARN("No GQ tag in %s VCF at %s:%lld", */
-            /*             callset_strs[callset].data(), ctg.data(), (long long)rec->pos); */
-            /* gq_missing_total++; // only warn once */
-            gq[0] = 0;
-        }
+        for (int t = 0; t < nthreads; t++)
+            parser.add_counts(*thread_counts[t]);
 
-        // parse GT
-        ngt = bcf_get_format_int32(hdr, rec, "GT", &gt, &ngt_arr);
-        if (ngt == -1) { // GT not defined in header
-            if (!gt_warn) {
-                gt_warn = true;
-                WARN("'GT' tag not defined in header, assuming monoploid");
-            }
-        } else if (ngt < 0) { // other error
-            ERROR("Failed to read %s GT at %s:%lld", 
-                    callset_strs[callset].data(), ctg.data(), (long long)rec->pos);
-        }
+    } else { // otherwise, stream all records
+        while (bcf_read(vcf, hdr, rec) == 0) {
 
-        // update ploidy info
-        int ctg_idx = std::find(contigs.begin(), contigs.end(), ctg) - contigs.begin();
-        if (ploidy[ctg_idx] != 0) { // already set, enforce it doesn't change
-            if (std::abs(ngt) != ploidy[ctg_idx] && ctg[ctg.size()-1] != 'X') {
-                if (g.verbosity > 1)
-                    WARN("Expected ploidy %d for all variants on contig '%s',"
-                          " found ploidy %d at %s:%lld in %s VCF.", ploidy[ctg_idx],
-                        ctg.data(), std::abs(ngt), ctg.data(), (long long)rec->pos,
-                        callset_strs[callset].data());
-                wrong_ploidy_total += 1;
-            }
-        } else { // set ploidy for this contig
-            ploidy[ctg_idx] = std::abs(ngt);
-        }
-
-        // parse genotype info
-        int orig_gt = GT_REF_REF;
-        bool same = false;
-        if (ngt == -1) { // no info, assume monoploid
-            orig_gt = GT_ALT1;
-        } else if (ngt == 1) { // monoploid/haploid
-
-            // set 1 if allele_idx > 0
-            orig_gt = bcf_gt_allele(gt[0]) ? GT_ALT1 : GT_REF;
-
-        } else if (ngt == 2) { // diploid
-
-            // missing, ignore
-            if (bcf_gt_is_missing(gt[0]) || bcf_gt_is_missing(gt[1])) {
-                orig_gt = GT_MISSING;
-
-            } else { // useful
-
-                // allow setting N/N to 1/1 later
-                if (bcf_gt_allele(gt[0]) == bcf_gt_allele(gt[1])) same = true;
-
-                if (bcf_gt_allele(gt[0]) == 0) { // REF
-                    switch (bcf_gt_allele(gt[1])) {
-                        case 0: orig_gt = GT_REF_REF; break;
-                        case 1: orig_gt = GT_REF_ALT1; break;
-                        default: orig_gt = GT_OTHER; break;
-                    }
-                } else if (bcf_gt_allele(gt[0]) == 1) { // ALT1
-                    switch (bcf_gt_allele(gt[1])) {
-                        case 0: orig_gt = GT_ALT1_REF; break;
-                        case 1: orig_gt = GT_ALT1_ALT1; break;
-                        case 2: orig_gt = GT_ALT1_ALT2; break;
-                        default: orig_gt = GT_OTHER; break;
-                    }
-                } else if (bcf_gt_allele(gt[0]) == 2) { // ALT2
-                    orig_gt = (bcf_gt_allele(gt[1]) == 1) ? GT_ALT2_ALT1 : GT_OTHER;
-                } else {
-                    orig_gt = GT_OTHER;
-                }
-            }
+            if (rec->rid != prev_rid) {
 
-        } else if (ngt > 2) { // polyploid
-            ERROR("Expected monoploid/diploid %s VCF, found variant with ploidy %d",
-                    callset_strs[callset].data(), ngt);
-        }
-        ngts[orig_gt]++;
-
-        // parse variant type
-        /* bool counted_unphased = false; */
-        for (int hap = 0; hap < std::abs(ngt); hap++) { // allow single-allele chrX, chrY
-
-            // set simplified GT (0|1, 1|0, or 1|1), (0|0 and .|. skipped later)
-            int simple_gt = hap ? GT_REF_ALT1 : GT_ALT1_REF; // 0|1 or 1|0 default
-            if (same) simple_gt = GT_ALT1_ALT1; // overwrite 1|1 if both agree
-
-            // get ref and allele, skipping ref query
-            std::string ref = rec->d.allele[0];
-            int alt_idx = ngt < 0 ? 1 : bcf_gt_allele(gt[hap]); // if no GT, assume 1
-            if (alt_idx < 0) {
-                if (g.verbosity > 1)
-                    WARN("Unknown allele (.) in %s VCF at %s:%lld, skipping",
-                        callset_strs[callset].data(), ctg.data(), (long long)rec->pos);
-                unknown_allele_total += 1;
-                continue;
-            }
-            if (alt_idx == 0) continue; // nothing to do if reference
-            std::string alt = rec->d.allele[alt_idx];
-
-            /* // count unphased variants (once per potentially diploid variant) */
-            /* if (!counted_unphased && !bcf_gt_is_phased(gt[hap])) { */
-            /*     if (g.verbosity > 1) */
-            /*         WARN("Unphased genotype in %s VCF at %s:%lld", */
-            /*             callset_strs[callset].data(), ctg.data(), (long long)rec->pos); */
-            /*     unphased_gt_total += 1; */
-            /*     counted_unphased = true; */
-            /* } */
-
-            // skip spanning deletion
-            if (alt == "*") { ntypes[hap][TYPE_REF]++; continue; }
-
-            // determine variant type
-            int pos = rec->pos;
-            int type = -1;
-            int lm = 0; // match from left->right (trim prefix)
-            int rm = -1;// match from right->left (simplify complex variants CPX->INDEL)
-            int reflen = int(ref.size());
-            int altlen = int(alt.size());
-            if (altlen-reflen > 0) { // insertion
-                while (lm < reflen && ref[lm] == alt[lm]) lm++;
-                while (reflen+rm >= lm && 
-                        ref[reflen+rm] == alt[altlen+rm]) rm--;
-                if (lm > reflen+rm) type = TYPE_INS; else type = TYPE_CPX;
-                pos += lm;
-                alt = alt.substr(lm, altlen+rm-lm+1);
-                ref = ref.substr(lm, reflen+rm-lm+1);
-
-            } else if (altlen-reflen < 0) { // deletion
-                while (lm < altlen && ref[lm] == alt[lm]) lm++;
-                while (altlen+rm >= lm && 
-                        ref[reflen+rm] == alt[altlen+rm]) rm--;
-                if (lm > altlen+rm) type = TYPE_DEL; else type = TYPE_CPX;
-                pos += lm;
-                alt = alt.substr(lm, altlen+rm-lm+1);
-                ref = ref.substr(lm, reflen+rm-lm+1);
-
-            } else { // substitution
-                if (ref.size() == 1) {
-                    type = (ref[0] == alt[0] ? TYPE_REF : TYPE_SUB);
-                    if (type == TYPE_REF) continue;
+                // start new contig
+                ctg = ctgnames[rec->rid];
+                prev_rid = rec->rid;
+                if (prev_rids.find(rec->rid) != prev_rids.end()) {
+                    ERROR("Unsorted %s VCF '%s', contig '%s' already parsed", 
+                            callset_strs[callset].data(), vcf_fn.data(), ctg.data());
                 } else {
-                    if (ref.substr(1) == alt.substr(1)){
-                        type = TYPE_SUB;
-                        ref = ref[0]; alt = alt[0]; // chop off matches
+                    for (int s = 0; s < parser.nsamples; s++) {
+                        vcfs[s]->contigs.push_back(ctg_ids[rec->rid]);
+                        vcfs[s]->ploidy.push_back(0);
+                        vcfs[s]->lengths.push_back(ctglens[rec->rid]);
+                        ploidy[s] = &vcfs[s]->ploidy.back();
                     }
-                    else type = TYPE_CPX;
-                }
-            }
-
-            // calculate reference length of variant
-            int rlen = 0;
-            switch (type) {
-                case TYPE_INS:
-                    rlen = 0; break;
-                case TYPE_SUB:
-                case TYPE_REF:
-                    rlen = 1; break;
-                case TYPE_DEL:
-                case TYPE_CPX:
-                    rlen = ref.size(); break;
-                default:
-                    ERROR("Unexpected variant type: %d", type);
-                    break;
-            }
-
-            // check that variant is in region of interest
-            uint8_t loc = g.bed.contains(ctg, pos, pos + rlen);
-            switch (loc) {
-                case BED_OUTSIDE: 
-                case BED_OFFCTG:
-                    nregions[loc]++;
-                    continue; // discard variant
-                case BED_INSIDE: 
-                case BED_BORDER:
-                    nregions[loc]++;
-                    break;
-                default:
-                    ERROR("Unexpected BED region type: %d", loc);
-                    break;
-            }
-
-            // skip variants that are too small or large
-            if (int(ref.size()) > g.max_size || int(alt.size()) > g.max_size) {
-                if (g.verbosity > 1)
-                    WARN("Large variant of length %d in %s VCF at %s:%lld, skipping",
-                        int(std::max(ref.size(), alt.size())),
-                        callset_strs[callset].data(), ctg.data(), (long long)rec->pos);
-                large_var_total++;
-                continue;
-            }
-            if (int(ref.size()) < g.min_size && int(alt.size()) < g.min_size) {
-                if (g.verbosity > 1)
-                    WARN("Small variant of length %d in %s VCF at %s:%lld, skipping",
-                        int(std::max(ref.size(), alt.size())),
-                        callset_strs[callset].data(), ctg.data(), (long long)rec->pos);
-                small_var_total++;
-                continue;
-            }
-
-            // TODO: keep overlaps, test all non-overlapping subsets?
-            // skip overlapping variants
-            if (prev_end[hap] > pos) { // warn if overlap
-                if (g.verbosity > 1) {
-                    WARN("Overlap in %s VCF variants at %s:%i, skipping", 
-                            callset_strs[callset].data(), ctg.data(), pos);
+                    parser.start_ctg(vcfs, ctg_ids[rec->rid], ploidy);
                 }
-                overlapping_var_total++;
-                continue;
-            }
-
-            // add to haplotype-specific query info
-            if (type == TYPE_CPX) { // split CPX into INS+DEL
-                this->ctg_variants[hap][ctg]->add_var(pos, 0, // INS
-                    hap, TYPE_INS, loc, "", alt, simple_gt, gq[0], vq);
-                this->ctg_variants[hap][ctg]->add_var(pos, rlen, // DEL
-                    hap, TYPE_DEL, loc, ref, "", simple_gt, gq[0], vq);
-            } else {
-                this->ctg_variants[hap][ctg]->add_var(pos, rlen,
-                        hap, type, loc, ref, alt, simple_gt, gq[0], vq);
             }
-
-            prev_end[hap] = pos + rlen;
-            npass[hap]++;
-            ntypes[hap][type]++;
+            parser.parse_record(rec, ctg);
         }
     }
 
-    /* if (gq_missing_total) */ 
-    /*     WARN("%d total missing GQ tags in %s VCF, all considered GQ=0", */
-    /*         gq_missing_total, callset_strs[callset].data()); */
-
-    if (unknown_allele_total) 
-        WARN("%d total unknown alleles (.) found in %s VCF, skipped",
-            unknown_allele_total, callset_strs[callset].data());
-
-    if (wrong_ploidy_total) 
-        WARN("%d total variants with incorrect ploidy found in %s VCF, kept",
-            wrong_ploidy_total, callset_strs[callset].data());
-
-    /* if (unphased_gt_total) */ 
-    /*     WARN("%d total unphased genotypes found in %s VCF", */
-    /*         unphased_gt_total, callset_strs[callset].data()); */
-
-    if (large_var_total)
-        WARN("%d total large %s VCF variant calls skipped, size > %d", 
-                large_var_total, callset_strs[callset].data(), g.max_size);
-
-    if (small_var_total)
-        WARN("%d total small %s VCF variant calls skipped, size < %d", 
-                small_var_total, callset_strs[callset].data(), g.min_size);
-
-    if (overlapping_var_total)
-        WARN("%d total overlapping %s VCF variant calls skipped", 
-                overlapping_var_total, callset_strs[callset].data());
-
-    if (g.verbosity >= 1) {
-        INFO("  Contigs:");
-        for (size_t i = 0; i < this->contigs.size(); i++) {
-            INFO("    [%2lu] %s: %d | %d variants", i, this->contigs[i].data(),
-                    this->ctg_variants[HAP1][this->contigs[i]]->n, 
-                    this->ctg_variants[HAP2][this->contigs[i]]->n);
-        }
-        INFO(" ");
-
-        INFO("  Genotypes:");
-        for (size_t i = 0; i < gt_strs.size(); i++) {
-            INFO("    %3s  %i", gt_strs[i].data(), ngts[i]);
-        }
-        INFO(" ");
-
-        INFO("  Variant exceeds min qual (%d):", g.min_qual);
-        INFO("    FAIL  %d", pass_min_qual[FAIL]);
-        INFO("    PASS  %d", pass_min_qual[PASS]);
-        INFO(" ");
-
-        INFO("  Variants in BED regions:");
-        for (size_t i = 0; i < region_strs.size(); i++) {
-            INFO("    %s  %i", region_strs[i].data(), nregions[i]);
+    for (int s = 0; s < parser.nsamples; s++) {
+        if (defer) {
+            vcfs[s]->deferred = true;
+            vcfs[s]->pass_filter_id = pass_filter_id;
+        } else {
+            vcfs[s]->print_summary(parser, s);
         }
-        INFO(" ");
-
-        INFO("  Variant types:");
-        if (g.verbosity >= 2) { // show each hap separately
-            for (int h = 0; h < HAPS; h++) {
-                INFO("    Haplotype %i", h+1);
-                for (size_t i = 0; i < type_strs.size(); i++) {
-                    INFO("      %s  %i", type_strs[i].data(), ntypes[h][i]);
-                }
-            }
-            INFO(" ");
-        } else { // summarize
-            for (size_t i = 0; i < type_strs.size(); i++) {
-                INFO("    %s  %i", type_strs[i].data(), 
-                        ntypes[HAP1][i] + ntypes[HAP2][i]);
-            }
-        }
-        INFO(" ");
-
-        INFO("  %s VCF overview:", callset_strs[callset].data());
-        INFO("    TOTAL %d", n);
-        INFO("    KEPT  %d", npass[HAP1] + npass[HAP2]);
     }
+    if (defer && g.verbosity >= 1)
+        INFO("  Found %d contigs, parsing their variants one contig window at a time",
+                int(vcfs[0]->contigs.size()));
 
-    free(gq);
-    free(fgq);
-    free(gt);
     free(ctgnames);
     bcf_hdr_destroy(hdr);
     bcf_close(vcf);
     bcf_destroy(rec);
-    return;
+    if (idx != NULL) hts_idx_destroy(idx);
+    if (tbx != NULL) tbx_destroy(tbx);
+    return vcfs;
 error2:
     free(ctgnames);
 error1:
     bcf_close(vcf);
     bcf_hdr_destroy(hdr);
-    return;
+    return vcfs;
 
 }
+
+/* Parse the variants on contigs `ctgs` of an indexed VCF, whose records were
+ * deferred by read_vcf() (see --contig-window), for the sample of `vcf`. The 
+ * returned window has the same header as take_contigs(ctgs). Other samples of
+ * a multi-sample VCF are decoded as well, but discarded.
+ */
+std::shared_ptr<variantData> read_vcf_window(
+        std::shared_ptr<variantData> vcf, const std::vector<int> & ctgs) {
+    std::shared_ptr<variantData> window = vcf->take_contigs(ctgs);
+    int callset = vcf->callset;
+
+    if (g.verbosity >= 1) INFO(" ");
+    if (g.verbosity >= 1) INFO("%s[%s 0/8] Parsing %s VCF%s '%s' window", 
+            COLOR_PURPLE, callset == QUERY ? "Q" : "T", callset_strs[callset].data(),
+            COLOR_WHITE, vcf->filename.data());
+    htsFile* fp = bcf_open(vcf->filename.data(), "r");
+    if (fp == NULL) ERROR("Failed to open %s VCF '%s'", 
+            callset_strs[callset].data(), vcf->filename.data());
+    bcf_hdr_t * hdr = bcf_hdr_read(fp);
+    hts_idx_t * idx = NULL;
+    tbx_t * tbx = NULL;
+    if (hts_get_format(fp)->format == bcf)
+        idx = bcf_index_load3(vcf->filename.data(), NULL, HTS_IDX_SILENT_FAIL);
+    else if (hts_get_format(fp)->compression == bgzf)
+        tbx = tbx_index_load3(vcf->filename.data(), NULL, HTS_IDX_SILENT_FAIL);
+    if (hdr == NULL || (idx == NULL && tbx == NULL))
+        ERROR("Failed to reload %s VCF '%s' index", 
+                callset_strs[callset].data(), vcf->filename.data());
+
+    // one variantData per sample, as parsed by read_vcf()
+    std::vector< std::shared_ptr<variantData> > vcfs;
+    int smp = -1;
+    for (int s = 0; s < bcf_hdr_nsamples(hdr); s++) {
+        std::shared_ptr<variantData> vcf_ptr(new variantData());
+        vcf_ptr->filename = vcf->filename;
+        vcf_ptr->callset = callset;
+        vcf_ptr->sample = hdr->samples[s];
+        vcfs.push_back(vcf_ptr);
+        if (vcf_ptr->sample == vcf->sample) smp = s;
+    }
+    if (smp < 0) ERROR("Sample '%s' not found in %s VCF '%s'", vcf->sample.data(),
+            callset_strs[callset].data(), vcf->filename.data());
+
+    // parse only this window's contigs
+    int nctg = 0;
+    const char **ctgnames = bcf_hdr_seqnames(hdr, &nctg);
+    std::vector<int> ctg_ids(nctg), rids;
+    for (int i = 0; i < nctg; i++) {
+        ctg_ids[i] = ctg_dict.id(ctgnames[i]);
+        if (std::find(window->contigs.begin(), window->contigs.end(), 
+                    ctg_ids[i]) == window->contigs.end()) continue;
+        rids.push_back(i);
+        for (auto & vcf_ptr : vcfs) vcf_ptr->init_ctg(ctg_ids[i]);
+    }
+    int nthreads = std::max(1, std::min(g.max_threads, int(rids.size())));
+    std::vector< std::vector<int> > ctg_ploidy(
+            vcfs.size(), std::vector<int>(nctg, 0));
+    std::vector<int> ctg_nrecs(nctg, 0);
+    std::vector< std::shared_ptr<vcfParser> > thread_counts(nthreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; t++) {
+        threads.push_back(std::thread(parse_ctgs_indexed, std::cref(vcfs),
+                    idx, tbx, vcf->pass_filter_id, std::cref(ctg_ids), std::cref(rids),
+                    false, t, nthreads, &ctg_ploidy, &ctg_nrecs, &thread_counts[t]));
+    }
+    for (auto & t : threads)
+        t.join();
+
+    for (int i : rids) {
+        for (int hap = 0; hap < HAPS; hap++)
+            std::swap(window->ctg_variants[hap][ctg_ids[i]], 
+                    vcfs[smp]->ctg_variants[hap][ctg_ids[i]]);
+    }
+    vcfParser parser(hdr, callset, vcf->pass_filter_id);
+    for (int t = 0; t < nthreads; t++)
+        parser.add_counts(*thread_counts[t]);
+    window->print_summary(parser, smp);
+
+    free(ctgnames);
+    bcf_hdr_destroy(hdr);
+    bcf_close(fp);
+    if (idx != NULL) hts_idx_destroy(idx);
+    if (tbx != NULL) tbx_destroy(tbx);
+    return window;
+}
@@ -2,13 +2,16 @@
 #define _VARIANT_H_
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <memory>
 
 #include "htslib/vcf.h"
+#include "htslib/tbx.h"
 
 #include "fasta.h"
+#include "bed.h"
 #include "defs.h"
 
 class ctgVariants {
@@ -20,9 +23,18 @@ public:
     // helper functions
     void add_cluster(int g);
     void add_var(int pos, int rlen, uint8_t hap, uint8_t type, uint8_t loc,
-            std::string ref, std::string alt, uint8_t orig_gt, float gq, float vq);
+            std::string_view ref, std::string_view alt, 
+            uint8_t orig_gt, float gq, float vq);
+    void add_variants(const std::vector<int> & cigar, int hap, int ref_pos,
+            std::string_view query, std::string_view ref, int qual);
+    void append(const ctgVariants & other);
+    std::string_view ref(int idx) const { return std::string_view(
+            this->alleles.data() + this->allele_offs[idx], this->ref_lens[idx]); }
+    std::string_view alt(int idx) const { return std::string_view(
+            this->alleles.data() + this->allele_offs[idx] + this->ref_lens[idx], 
+            this->alt_lens[idx]); }
     void print_var_info(FILE* out_vcf, std::shared_ptr<fastaData> ref, 
-            std::string ctg, int idx);
+            int ctg, int idx);
     void print_var_empty(FILE* out_vcf, bool query = false);
     void print_var_sample(FILE* out_vcf, int idx, std::string gt, 
             int sc_idx, bool swap, bool query = false);
@@ -33,13 +45,17 @@ public:
     std::vector<uint8_t> haps;      // variant haplotype
     std::vector<uint8_t> types;     // variant type: NONE, SUB, INS, DEL, GRP
     std::vector<uint8_t> locs;      // BED location: INSIDE, OUTSIDE, BORDER
-    std::vector<std::string> refs;  // variant reference allele
-    std::vector<std::string> alts;  // variant alternate allele (always one)
+    std::vector<int> allele_offs;   // offset of REF (then ALT) allele in pool
+    std::vector<int> ref_lens;      // variant reference allele length
+    std::vector<int> alt_lens;      // variant alternate allele length (one ALT)
     std::vector<uint8_t> orig_gts;  // simple genotype (0|1, 1|0, or 1|1)
     std::vector<float> gt_quals;    // genotype quality (0-60)
     std::vector<float> var_quals;   // variant quality (0-60)
     int n = 0;
 
+    // REF and ALT bases of all variants, concatenated
+    std::string alleles;
+
     // set during (swg_)cluster()
     std::vector<int> clusters;      // indices of clusters in this struct's vectors
 
@@ -50,36 +66,112 @@ public:
     std::vector<float> credit;      // fraction of TP for partial positive (PP)
 };
 
+/* Per-sample parsing state and filtering counters for one VCF sample column. */
+class vcfSample {
+public:
+    vcfSample();
+
+    void add_counts(const vcfSample & other);
+
+    // contig context, set by vcfParser::start_ctg()
+    std::vector< std::shared_ptr<ctgVariants> > vars;
+    int * ploidy = NULL;
+    std::vector<int> prev_end;      // end of previous kept variant, per hap
+    std::vector<bedCursor> bed;     // BED region classifier, per hap
+
+    // counters
+    std::vector< std::vector<int> > ntypes;
+    std::vector<int> npass;         // alleles PASSing all filters
+    std::vector<int> ngts;
+    std::vector<int> nregions;
+    int overlapping_var_total = 0;
+    int unknown_allele_total = 0;
+    int small_var_total = 0;
+    int large_var_total = 0;
+    int wrong_ploidy_total = 0;
+};
+
+class variantData;
+
+class vcfParser {
+public:
+    vcfParser(bcf_hdr_t * hdr, int callset, int pass_filter_id);
+    ~vcfParser();
+
+    // functions
+    void start_ctg(const std::vector< std::shared_ptr<variantData> > & vcfs,
+            int ctg, const std::vector<int*> & ploidy);
+    void parse_record(bcf1_t * rec, const std::string & ctg);
+    void parse_sample(bcf1_t * rec, const std::string & ctg, int s, 
+            const int * gt, int ngt, float vq);
+    void add_counts(const vcfParser & other);
+
+    // record context
+    bcf_hdr_t * hdr;
+    int callset;
+    int pass_filter_id;
+    int nsamples;
+
+    // decoding buffers, shared by all samples of a record
+    int ngq_arr = 0;
+    int nfgq_arr = 0;
+    int * gq = NULL;
+    float * fgq = NULL;
+    bool int_qual = true;
+    std::vector<float> gqs;         // genotype quality, per sample
+    int ngt_arr = 0;
+    int * gt = NULL;
+    bool gt_warn = false;
+
+    // counters
+    int n = 0;                      // total number of records parsed
+    std::vector<int> pass_min_qual;
+    std::vector<vcfSample> samples;
+};
+
 class variantData {
 public:
     // constructors
     variantData();
-    variantData(std::string vcf_fn, 
-            std::shared_ptr<fastaData> reference, int callset);
 
     // functions
     void write_vcf(std::string vcf_fn);
-    void print_variant(FILE* out_fp, std::string ctg, int pos, int type,
-        std::string ref, std::string alt, float qual, std::string gt);
+    void append_vcf(std::string vcf_fn);
+    void write_vcf_header(FILE* out_fp);
+    void write_vcf_records(FILE* out_fp);
+    void print_variant(FILE* out_fp, int ctg, int pos, int type,
+        std::string_view ref, std::string_view alt, float qual, std::string gt);
     void set_header(const std::shared_ptr<variantData> vcf);
-    void add_variants( const std::vector<int> & cigar, 
-        int hap, int ref_pos, const std::string & ctg, 
-        const std::string & query, const std::string & ref, int qual);
+    void init_ctg(int ctg);
+    std::shared_ptr<variantData> take_contigs(const std::vector<int> & ctgs);
     void left_shift();
+    void print_summary(const vcfParser & parser, int s);
 
     // data
     int callset;                     // 0=QUERY, 1=TRUTH
     std::string filename;
     std::string sample;
-    std::vector<std::string> contigs;
+    std::vector<int> contigs;        // contig IDs, in VCF order
     std::vector<int> lengths;
     std::vector<int> ploidy;
-    std::vector< // ctg_variants[hap][ctg] -> variants
-        std::unordered_map<
-            std::string, 
-            std::shared_ptr<ctgVariants> > > ctg_variants;
+    std::vector< // ctg_variants[hap][ctg ID] -> variants
+        std::vector< std::shared_ptr<ctgVariants> > > ctg_variants;
+    bool deferred = false;           // variants parsed by read_vcf_window()
+    int pass_filter_id = 0;
 
     std::shared_ptr<fastaData> ref;
 };
 
+std::vector<std::string> read_vcf_samples(const std::string & vcf_fn, int callset);
+std::vector< std::shared_ptr<variantData> > read_vcf(std::string vcf_fn, 
+        std::shared_ptr<fastaData> reference, int callset);
+std::shared_ptr<variantData> read_vcf_window(
+        std::shared_ptr<variantData> vcf, const std::vector<int> & ctgs);
+void parse_ctgs_indexed(const std::vector< std::shared_ptr<variantData> > & vcfs,
+        hts_idx_t * idx, tbx_t * tbx, int pass_filter_id,
+        const std::vector<int> & ctg_ids, const std::vector<int> & rids, bool probe,
+        int thread_id, int nthreads, 
+        std::vector< std::vector<int> > * ctg_ploidy, 
+        std::vector<int> * ctg_nrecs, std::shared_ptr<vcfParser> * counts);
+
 #endif